@@ -102,6 +102,45 @@ struct company {
     }
 };
 
+// decode employee directly from tokens, without intermediate values
+employee read_employee(ujson::reader &reader) {
+
+    employee e{ "", "", 0.0, false };
+    reader.expect(ujson::token::object_begin);
+    bool more = reader.peek_token() != ujson::token::object_end;
+    while (more) {
+        reader.expect(ujson::token::string);
+        auto name = std::string(reader.read_string_view());
+        reader.expect(ujson::token::colon);
+        if (name == "first_name") {
+            reader.expect(ujson::token::string);
+            e.first_name = reader.read_string();
+        } else if (name == "last_name") {
+            reader.expect(ujson::token::string);
+            e.last_name = reader.read_string();
+        } else if (name == "accumulated_bonus") {
+            reader.expect(ujson::token::number);
+            e.accumulated_bonus = reader.read_double();
+        } else if (name == "married") {
+            auto t = reader.read_token();
+            if (t != ujson::token::true_value &&
+                t != ujson::token::false_value)
+                throw ujson::exception(ujson::error_code::invalid_syntax,
+                                       reader.line());
+            e.married = t == ujson::token::true_value;
+        } else {
+            reader.skip_value();
+        }
+
+        // members are separated by commas
+        more = reader.peek_token() != ujson::token::object_end;
+        if (more)
+            reader.expect(ujson::token::comma);
+    }
+    reader.expect(ujson::token::object_end);
+    return e;
+}
+
 ujson::value to_json(company const &c) {
     return ujson::object{ { "name", c.name },
                           { "revenue", c.revenue },
@@ -127,7 +166,38 @@ int main(int argc, const char *argv[]) {
         // parse string rep and reconstruct object
         auto c1 = company(ujson::parse(string));
 
-        if (c0 == c1)
+        // alternatively only decode the employees using a reader
+        std::vector<employee> employees;
+        ujson::reader reader(string.c_str(), string.length());
+        reader.expect(ujson::token::object_begin);
+        bool more = reader.peek_token() != ujson::token::object_end;
+        while (more) {
+            reader.expect(ujson::token::string);
+            auto name = reader.read_string_view();
+            reader.expect(ujson::token::colon);
+            if (std::string(name) != "employees") {
+                reader.skip_value();
+            } else {
+                reader.expect(ujson::token::array_begin);
+                bool more_employees =
+                    reader.peek_token() != ujson::token::array_end;
+                while (more_employees) {
+                    employees.push_back(read_employee(reader));
+                    more_employees =
+                        reader.peek_token() != ujson::token::array_end;
+                    if (more_employees)
+                        reader.expect(ujson::token::comma);
+                }
+                reader.expect(ujson::token::array_end);
+            }
+
+            more = reader.peek_token() != ujson::token::object_end;
+            if (more)
+                reader.expect(ujson::token::comma);
+        }
+        reader.expect(ujson::token::object_end);
+
+        if (c0 == c1 && employees == c0.employees)
             std::cout << "Success!" << std::endl;
         else
             std::cout << "Failure!" << std::endl;
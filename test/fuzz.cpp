@@ -28,33 +28,24 @@
 int main(int argc, const char *argv[]) {
     try {
 
-        std::FILE *file = nullptr;
-        if (argc == 1) {
-            file = stdin;     
-        } else if (argc == 2) {
-            file = std::fopen(argv[1], "rb");
-            if (!file) {
-                std::printf("unable to open '%s'\n", argv[1]);
-                return EXIT_FAILURE;
-            }
+        if (argc == 2) {
+            ujson::parse_file(argv[1]);
+            return EXIT_SUCCESS;
         }
-        else {
+        if (argc != 1) {
             std::printf("ujson_fuzz {<} filename.json\n");
             return EXIT_FAILURE;
         }
 
         std::string json;
         for (;;) {
-            char buf[64];
-            auto read = std::fread(buf, 1, sizeof(buf), file);
+            char buf[4096];
+            auto read = std::fread(buf, 1, sizeof(buf), stdin);
             json.append(buf, buf + read);
-            if (std::feof(file))
+            if (std::feof(stdin) || std::ferror(stdin))
                 break;
         }
 
-        if (file != stdin)
-            std::fclose(file);
-
         ujson::parse(json);
         return EXIT_SUCCESS;
 
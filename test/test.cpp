@@ -30,9 +30,13 @@
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <functional>
 #include <future>
+#include <sstream>
 
 #ifndef M_PI
 #define M_E         2.7182818284590452354
@@ -254,6 +258,76 @@ TEST_CASE("number") {
 
     // overflow
     REQUIRE_THROWS(parse("1.8e+308"));
+    REQUIRE_THROWS(parse("-1e99999999999"));
+
+    // correctly rounded, including halfway cases, subnormals, underflow,
+    // significands with more than 19 digits and exponents where the fast
+    // paths need the second half of the power of five
+    const char *numbers[] = {
+        "9007199254740993", "9007199254740992.5", "9007199254740995",
+        "2.2250738585072011e-308", "2.2250738585072012e-308",
+        "4.9406564584124654e-324", "2.4703282292062327e-324",
+        "2.4703282292062328e-324", "1.7976931348623157e308",
+        "1.7976931348623158e308", "7.2057594037927933e16", "89255.0e-22",
+        "8.98846567431158e307", "1.00000005960464477550", "3.0540412e5",
+        "0.1", "-0.3", "1e-400", "0e999", "123456789012345678901234567890",
+        "0.00000000000000000000123456789012345678901234",
+        "12345678901234567890", "1234567890123456789", "0.000000001e9",
+        "4.35679845e-201", "-1.2345e-308", "1e22", "1e23", "9.999e22"
+    };
+    for (auto number : numbers)
+        REQUIRE(double_cast(parse(number)) == std::strtod(number, nullptr));
+    REQUIRE(std::signbit(double_cast(parse("-0.0e5"))));
+
+    // 64 bit integers are stored and written exactly
+    const auto int64_min = std::numeric_limits<std::int64_t>::min();
+    const auto int64_max = std::numeric_limits<std::int64_t>::max();
+    const auto uint64_max = std::numeric_limits<std::uint64_t>::max();
+    REQUIRE(int64_cast(parse("9007199254740993")) == 9007199254740993);
+    REQUIRE(int64_cast(parse("-9223372036854775808")) == int64_min);
+    REQUIRE(int64_cast(parse("9223372036854775807")) == int64_max);
+    REQUIRE(uint64_cast(parse("18446744073709551615")) == uint64_max);
+    REQUIRE(parse("9223372036854775808").is_uint64());
+    REQUIRE(parse("-12").is_int64());
+    REQUIRE_FALSE(parse("18446744073709551616").is_uint64());
+    REQUIRE_FALSE(parse("-9223372036854775809").is_int64());
+    REQUIRE_FALSE(parse("1.0").is_int64());
+    REQUIRE_FALSE(parse("1e2").is_int64());
+    REQUIRE(std::signbit(double_cast(parse("-0"))));
+    for (auto json : { "0", "-1", "9007199254740993", "-9223372036854775808",
+                       "18446744073709551615", "[12345678901234567890]" })
+        REQUIRE(to_string(parse(json), compact_ascii) == json);
+
+    // casts check the range of any representation
+    REQUIRE_THROWS(int64_cast(value(uint64_max)));
+    REQUIRE_THROWS(uint64_cast(value(std::int64_t(-1))));
+    REQUIRE_THROWS(int32_cast(value(std::int64_t(1) << 31)));
+    REQUIRE_THROWS(uint64_cast(value(1.8446744073709552e19)));
+    REQUIRE_THROWS(int64_cast(value(9.2233720368547758e18)));
+    REQUIRE(int64_cast(value(-9.2233720368547758e18)) == int64_min);
+    REQUIRE(uint32_cast(value(std::uint64_t(7))) == 7);
+    REQUIRE(double_cast(value(uint64_max)) == 1.8446744073709552e19);
+
+    // numbers are equal if their values are, whatever the representation
+    REQUIRE(value(std::int64_t(5)) == value(5.0));
+    REQUIRE(value(std::uint64_t(5)) == value(std::int64_t(5)));
+    REQUIRE(value(5.5) != value(std::int64_t(5)));
+    REQUIRE(parse("9007199254740993") != value(9007199254740992.0));
+    REQUIRE(value(uint64_max) != value(1.8446744073709552e19));
+    REQUIRE(value(std::int64_t(-1)) != value(uint64_max));
+
+    // numbers of every length, ending at the end of the input
+    std::string digits;
+    for (int i = 1; i < 40; ++i) {
+        digits += static_cast<char>('0' + i * 7 % 10);
+        for (auto number : { digits, "-" + digits, "0." + digits,
+                             digits + "." + digits, digits + "e-17" }) {
+            reader reader(number.data(), number.size());
+            REQUIRE(reader.read_token() == token::number);
+            REQUIRE(reader.read_double() ==
+                    std::strtod(number.c_str(), nullptr));
+        }
+    }
 }
 
 TEST_CASE("string") {
@@ -612,6 +686,161 @@ TEST_CASE("misc") {
     REQUIRE(b != "foo");
 }
 
+// records parse events as a compact string
+struct event_recorder : ujson::handler {
+    void on_null() override { events += "n"; }
+    void on_bool(bool b) override { events += b ? "t" : "f"; }
+    void on_number(double d) override {
+        events += "#" + std::to_string(static_cast<int>(d));
+    }
+    void on_string(ujson::string_view str) override {
+        events += "s:" + std::string(str) + ";";
+    }
+    void on_start_array() override { events += "["; }
+    void on_end_array() override { events += "]"; }
+    void on_start_object() override { events += "{"; }
+    void on_key(ujson::string_view key) override {
+        events += "k:" + std::string(key) + ";";
+    }
+    void on_end_object() override { events += "}"; }
+    std::string events;
+};
+
+TEST_CASE("handler") {
+
+    using namespace ujson;
+
+    auto events = [](const char *json) {
+        event_recorder recorder;
+        parse(json, 0, recorder);
+        return recorder.events;
+    };
+
+    REQUIRE(events("null") == "n");
+    REQUIRE(events(" [ true, false, 42 ] ") == "[tf#42]");
+    REQUIRE(events("{ \"b\" : \"x\\ty\", \"a\" : [ {} ] }") ==
+            "{k:b;s:x\ty;k:a;[{}]}");
+
+    // object members are reported in document order, not sorted
+    REQUIRE(events("{ \"z\" : 1, \"a\" : 2 }") == "{k:z;#1k:a;#2}");
+
+    // strings without escapes are passed from the input without copying
+    struct view_recorder : handler {
+        void on_string(string_view str) override { views.push_back(str); }
+        void on_key(string_view key) override { views.push_back(key); }
+        std::vector<string_view> views;
+    } views;
+    const char *plain = "{ \"key\" : \"value\" }";
+    parse(plain, 0, views);
+    REQUIRE(views.views.size() == 2);
+    REQUIRE(views.views[0].data() == plain + 3);
+    REQUIRE(views.views[1].data() == plain + 11);
+
+    // default callbacks ignore events
+    handler ignore;
+    REQUIRE_NOTHROW(parse("[ null, { \"a\" : \"b\" } ]", ignore));
+
+    // exact integers, if the handler wants them
+    struct integer_recorder : handler {
+        void on_number(double d) override { numbers.push_back(d); }
+        void on_int64(std::int64_t i) override { ints.push_back(i); }
+        std::vector<double> numbers;
+        std::vector<std::int64_t> ints;
+    } integers;
+    parse("[ -9223372036854775807, 2.5, 18446744073709551615 ]", integers);
+    REQUIRE(integers.ints.size() == 1);
+    REQUIRE(integers.ints[0] == -9223372036854775807);
+    REQUIRE(integers.numbers.size() == 2);
+    REQUIRE(integers.numbers[1] == 1.8446744073709552e19);
+
+    // same errors as parsing into values
+    REQUIRE_THROWS(parse("[ 1, 2 ", ignore));
+    REQUIRE_THROWS(parse("[ 1 ] 2", ignore));
+    REQUIRE_THROWS(parse("{ 1 : 2 }", ignore));
+    REQUIRE_THROWS(parse("\"\xFF\"", ignore));
+    REQUIRE_THROWS(parse("1e400", ignore));
+}
+
+TEST_CASE("reader") {
+
+    using namespace ujson;
+
+    const char *json = "{ \"id\" : 42, \"tags\" : [ \"a\", { \"b\" : [] } ],"
+                       "  \"name\" : \"plain\", \"escaped\" : \"x\\ny\" }";
+    reader r(json);
+    r.expect(token::object_begin);
+
+    REQUIRE(r.read_token() == token::string);
+    REQUIRE(std::string(r.read_string_view()) == "id");
+    r.expect(token::colon);
+    REQUIRE(r.read_token() == token::number);
+    REQUIRE(r.read_double() == 42);
+
+    // skip whole subtree
+    r.expect(token::comma);
+    r.expect(token::string);
+    REQUIRE(r.read_string() == "tags");
+    r.expect(token::colon);
+    REQUIRE(r.peek_token() == token::array_begin);
+    r.skip_value();
+
+    // strings without escapes are views into the buffer
+    r.expect(token::comma);
+    r.expect(token::string);
+    r.expect(token::colon);
+    r.expect(token::string);
+    auto plain = r.read_string_view();
+    REQUIRE(plain.data() > json);
+    REQUIRE(plain.data() < json + std::strlen(json));
+    REQUIRE(std::string(plain) == "plain");
+
+    // but are unescaped into an internal buffer otherwise
+    r.expect(token::comma);
+    r.expect(token::string);
+    r.expect(token::colon);
+    r.expect(token::string);
+    REQUIRE(std::string(r.read_string_view()) == "x\ny");
+
+    r.expect(token::object_end);
+    REQUIRE(r.read_token() == token::eof);
+    REQUIRE(r.read_token() == token::eof);
+
+    // read values
+    reader r2("[ 1, { \"a\" : [ true ] }, null ]");
+    r2.expect(token::array_begin);
+    r2.skip_value();
+    r2.expect(token::comma);
+    REQUIRE((r2.read_value() == object{ { "a", array{ true } } }));
+    r2.expect(token::comma);
+    REQUIRE(r2.read_value() == null);
+    r2.expect(token::array_end);
+
+    // errors
+    reader r3("[ 1 : 2 ]");
+    r3.expect(token::array_begin);
+    r3.expect(token::number);
+    REQUIRE_THROWS(r3.expect(token::comma));
+    reader r4("[ 1 2 ]");
+    REQUIRE_THROWS(r4.skip_value());
+    reader r5("{ \"a\" 1 }");
+    REQUIRE_THROWS(r5.skip_value());
+    std::string nested;
+    for (int i = 0; i < 1100; ++i)
+        nested += i % 2 ? "[" : "{\"a\":";
+    for (int i = 1100; i-- > 0;)
+        nested += i % 2 ? "]" : "}";
+    const auto valid = "[" + nested + ", 1]";
+    reader r5a(valid.c_str());
+    r5a.skip_value();
+    REQUIRE(r5a.read_token() == token::eof);
+    const auto mismatched = "[" + nested + "}";
+    reader r5b(mismatched.c_str());
+    REQUIRE_THROWS(r5b.skip_value());
+    reader r6("  \n x");
+    REQUIRE_THROWS(r6.peek_token());
+    REQUIRE(r6.line() == 2);
+}
+
 // ---------------------------------------------------------------------------
 // George Marsaglia's Multiply-With-Carry RNG
 
@@ -744,6 +973,1128 @@ static ujson::value gen_object(int depth) {
     return result;
 }
 
+TEST_CASE("scanner") {
+
+    using namespace ujson;
+
+    // run with every kernel level, including the portable scalar one
+    const auto detected = detect_simd_level();
+    for (auto level : { simd_level::scalar, simd_level::sse2,
+                        simd_level::ssse3, simd_level::avx2,
+                        simd_level::avx512 }) {
+        set_simd_level(level);
+
+        // strings and white space crossing 64 byte block boundaries
+        for (std::size_t ws = 0; ws < 70; ws += 3) {
+            const std::string space(ws, ' ');
+            for (std::size_t len = 0; len < 140; ++len) {
+                std::string str(len, 'x');
+                auto json =
+                    space + "[" + space + "\"" + str + "\"" + space + "]";
+                REQUIRE(parse(json) == value(array{ str }));
+
+                // unterminated
+                json = space + "\"" + str;
+                REQUIRE_THROWS(parse(json));
+
+                if (len == 0)
+                    continue;
+
+                // escapes, non-ascii and control characters take the slow
+                // path
+                auto i = len / 2;
+                str[i] = '\\';
+                str.insert(i + 1, "n");
+                json = space + "\"" + str + "\"";
+                auto expected = std::string(len, 'x');
+                expected[i] = '\n';
+                REQUIRE(parse(json) == expected);
+
+                str = std::string(len, 'x') + "\xC3\xA6";
+                json = space + "\"" + str + "\"" + space;
+                REQUIRE(parse(json) == str);
+
+                str = std::string(len, 'x');
+                str[i] = '\t';
+                json = space + "\"" + str + "\"";
+                REQUIRE_THROWS(parse(json));
+            }
+        }
+
+        // escapes and utf-8 mixed, crossing block boundaries
+        std::string json = "\"", expected;
+        for (int i = 0; i < 40; ++i) {
+            json += "ab\\n\xC3\xA6\\u00e6";
+            json += "\\uD83C\\uDF7B\xF0\x9F\x8D\xBB\\/";
+            expected += "ab\n\xC3\xA6\xC3\xA6";
+            expected += "\xF0\x9F\x8D\xBB\xF0\x9F\x8D\xBB/";
+        }
+        json += "\"";
+        REQUIRE(parse(json) == expected);
+        reader reader(json.data(), json.size());
+        reader.expect(token::string);
+        REQUIRE(std::string(reader.read_string_view()) == expected);
+        REQUIRE(reader.read_string() == expected);
+
+        for (auto invalid :
+             { "\"\\x\"", "\"\\u12G4\"", "\"\\uD800\"", "\"\\uDC00\"",
+               "\"\\uD800\\u0041\"", "\"\\uD800x\"", "\"\\u00\"",
+               "\"\xC0\x80\"", "\"\xE0\x80\x80\"", "\"\xED\xA0\x80\"",
+               "\"\xF4\x90\x80\x80\"", "\"\xF5\x80\x80\x80\"", "\"\x80\"",
+               "\"\xC3\"", "\"\xE6\x97\"", "\"\xC3", "\"\\" }) {
+            REQUIRE_THROWS(parse(invalid));
+        }
+    }
+    set_simd_level(detected);
+}
+
+TEST_CASE("simd") {
+
+    using namespace ujson;
+
+    // strings with a char needing special care at every position and
+    // lengths covering the vector widths and tails of all kernels
+    std::vector<std::string> strings;
+    const char *specials[] = { "\\", "\"", "\n", "\x1F", "\x7F",
+                               "\xC3\xA6", "\xF0\x9F\x8D\xBB" };
+    for (std::size_t len = 0; len < 140; len += len < 70 ? 1 : 7) {
+        strings.push_back(std::string(len, 'x'));
+        for (auto special : specials)
+            for (std::size_t i = 0; i < len; i += 5)
+                strings.push_back(std::string(i, 'x') + special +
+                                  std::string(len - i, 'x'));
+    }
+    strings.push_back(gen_string(4096));
+
+    // results with the scalar kernels are the reference
+    const auto detected = detect_simd_level();
+    set_simd_level(simd_level::scalar);
+    REQUIRE(get_simd_level() == simd_level::scalar);
+    std::vector<std::string> ascii, utf8;
+    for (auto const &str : strings) {
+        ascii.push_back(to_string(str));
+        utf8.push_back(to_string(str, indented_utf8));
+    }
+
+    for (auto level : { simd_level::scalar, simd_level::sse2,
+                        simd_level::ssse3, simd_level::avx2,
+                        simd_level::avx512 }) {
+        set_simd_level(level);
+        REQUIRE(get_simd_level() == std::min(level, detected));
+        for (std::size_t i = 0; i < strings.size(); ++i) {
+            REQUIRE(to_string(strings[i]) == ascii[i]);
+            REQUIRE(to_string(strings[i], indented_utf8) == utf8[i]);
+            REQUIRE(parse(ascii[i]) == strings[i]);
+            REQUIRE(parse(utf8[i]) == strings[i]);
+            REQUIRE(parse("[" + std::string(i % 70, ' ') + utf8[i] + "]") ==
+                    value(array{ strings[i] }));
+        }
+
+        // invalid utf-8 after a long ascii prefix
+        auto invalid = std::string(100, 'x') + "\xC3\x28";
+        REQUIRE_THROWS(value(invalid, validate_utf8::yes));
+
+        // sequences at every offset across chunk boundaries, after both
+        // ascii and multibyte text
+        const char *valid_sequences[] = {
+            "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF",
+            "\xEE\x80\x80", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+            "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E"
+        };
+        const char *invalid_sequences[] = {
+            "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xC2", "\xC2\x7F",
+            "\xE0\x9F\xBF", "\xED\xA0\x80", "\xE1\x80", "\xF0\x8F\xBF\xBF",
+            "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF1\x80\x80",
+            "\xC2\x80\x80", "\xFF"
+        };
+        std::string multibyte;
+        for (std::size_t i = 0; i < 70; ++i) {
+            if (i % 2)
+                multibyte += "\xC3\xA6";
+            for (auto const &prefix : { std::string(i, 'x'), multibyte }) {
+                for (auto seq : valid_sequences) {
+                    auto str = prefix + seq;
+                    REQUIRE(value(str, validate_utf8::yes) == str);
+                    REQUIRE(parse('"' + str + '"') == str);
+                }
+                for (auto seq : invalid_sequences) {
+                    auto str = prefix + seq;
+                    REQUIRE_THROWS(value(str, validate_utf8::yes));
+                    REQUIRE_THROWS(value(str + "xx", validate_utf8::yes));
+                    REQUIRE_THROWS(parse('"' + str + '"'));
+                }
+            }
+        }
+    }
+
+    set_simd_level(detected);
+    REQUIRE(get_simd_level() == detected);
+}
+
+TEST_CASE("padded") {
+
+    using namespace ujson;
+
+    std::vector<std::string> documents = {
+        "[]", "123", "-1.5e3", "true", "\"abc\"", "\"esc \\u00e6\\n\"",
+        "{ \"a\" : [ 1, 2, null ], \"b\" : false }  \n",
+        to_string(gen_object(0))
+    };
+    for (auto const &json : documents) {
+        auto expected = parse(json);
+        REQUIRE(parse_padded(padded_buffer(json)) == expected);
+
+        // caller owned buffer with room for the padding
+        std::vector<char> buffer(json.begin(), json.end());
+        buffer.resize(json.size() + padding);
+        REQUIRE(parse_padded(buffer.data(), json.size()) == expected);
+    }
+
+    // tokens cut short by the end of the input
+    for (auto json : { "", "[1, tru", "\"abc", "\"abc\\", "[1, 2", "1 2",
+                       "{ \"a\" :", "-" }) {
+        REQUIRE_THROWS(parse_padded(padded_buffer(json, std::strlen(json))));
+    }
+
+    padded_buffer buffer(5);
+    std::memcpy(buffer.data(), "[ 7 ]", 5);
+    reader reader(buffer);
+    REQUIRE(reader.read_value() == value(array{ 7 }));
+    REQUIRE(reader.read_token() == token::eof);
+}
+
+TEST_CASE("raw_numbers") {
+
+    using namespace ujson;
+
+    parse_options opts;
+    opts.raw_numbers = true;
+
+    // written back exactly as in the input, whatever the precision
+    const std::string json =
+        "[1.50,-0,1e2,3.14159265358979323846264338327950288,"
+        "123456789012345678901234567890,0.1]";
+    auto v = parse(json, opts);
+    REQUIRE(to_string(v, compact_ascii) == json);
+    REQUIRE(to_string(parse(json), compact_ascii) ==
+            "[1.5,-0,100,3.141592653589793,1.2345678901234568e29,0.1]");
+
+    // converted when cast
+    auto const &numbers = array_cast(v);
+    REQUIRE(numbers[0].is_raw_number());
+    REQUIRE(numbers[0].is_number());
+    REQUIRE(std::string(raw_number_cast(numbers[0])) == "1.50");
+    REQUIRE(double_cast(numbers[0]) == 1.5);
+    REQUIRE(int32_cast(numbers[2]) == 100);
+    REQUIRE(double_cast(numbers[3]) == M_PI);
+    REQUIRE_THROWS(int64_cast(numbers[4]));
+    REQUIRE_THROWS(raw_number_cast(value(1.5)));
+    try {
+        double_cast(parse("1e999", opts));
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_error_code() == error_code::bad_number);
+        REQUIRE(e.get_line() == -1);
+    }
+    REQUIRE(uint64_cast(parse("18446744073709551615", opts)) ==
+            std::numeric_limits<std::uint64_t>::max());
+
+    // compared by value
+    REQUIRE(numbers[0] == value(1.5));
+    REQUIRE(value(1.5) == numbers[0]);
+    REQUIRE(parse("1.0", opts) == parse("1", opts));
+    REQUIRE(parse("1", opts) == value(1));
+    REQUIRE(parse("2", opts) != parse("1", opts));
+    REQUIRE(parse("\"1\"", opts) != parse("1", opts));
+
+    // copies share or copy the text
+    value copy = numbers[3];
+    REQUIRE(std::string(raw_number_cast(copy)) ==
+            std::string(raw_number_cast(numbers[3])));
+    REQUIRE(to_string(parse(" [ 1.0 ] ", opts), compact_ascii) == "[1.0]");
+
+    // same syntax as without the option
+    for (auto invalid : { "01", "1.", "-", "1e", "[1,]", ".5" })
+        REQUIRE_THROWS(parse(invalid, opts));
+}
+
+TEST_CASE("borrowed_strings") {
+
+    using namespace ujson;
+
+    parse_options opts;
+    opts.borrowed_strings = true;
+
+    const std::string json =
+        "{\"escaped\":\"a\\nb\",\"list\":[\"\",\"x\"],"
+        "\"name\":\"a long string without escapes\"}";
+    auto v = parse(json, opts);
+    auto const begin = json.data();
+    auto const end = begin + json.size();
+
+    // unescaped strings refer to the input
+    auto name = find(object_cast(v), "name");
+    REQUIRE(name->second.is_borrowed_string());
+    auto text = string_cast(name->second);
+    REQUIRE(text.data() > begin);
+    auto const text_end = text.data() + text.length();
+    REQUIRE(text_end < end);
+    REQUIRE(std::string(text) == "a long string without escapes");
+
+    // escaped strings are copied
+    auto escaped = find(object_cast(v), "escaped");
+    REQUIRE_FALSE(escaped->second.is_borrowed_string());
+    REQUIRE(std::string(string_cast(escaped->second)) == "a\nb");
+
+    // compared by contents
+    REQUIRE(name->second == value("a long string without escapes"));
+    REQUIRE(value("a long string without escapes") == name->second);
+    REQUIRE(name->second != value("a long string"));
+    REQUIRE(name->second != value(1));
+    REQUIRE(v == parse(json));
+    REQUIRE(to_string(v, compact_ascii) == json);
+
+    // copies refer to the same buffer, moving out copies the contents
+    value copy = name->second;
+    REQUIRE(copy.is_borrowed_string());
+    REQUIRE(string_cast(copy).data() == text.data());
+    std::string moved = string_cast(std::move(copy));
+    REQUIRE(moved == "a long string without escapes");
+    REQUIRE(copy.is_null());
+
+    auto list = find(object_cast(v), "list");
+    REQUIRE(string_cast(array_cast(list->second)[0]).length() == 0);
+    REQUIRE(std::string(string_cast(array_cast(list->second)[1])) == "x");
+}
+
+TEST_CASE("insitu") {
+
+    using namespace ujson;
+
+    std::string json = "[\"plain\",\"tab\\tand \\u00e9\",{\"key\":\"\"}]";
+    auto v = parse_insitu(&json[0], json.size());
+    REQUIRE(v == parse("[\"plain\",\"tab\\tand \\u00e9\",{\"key\":\"\"}]"));
+
+    // strings, escaped or not, are zero terminated views of the buffer
+    auto const &elements = array_cast(v);
+    for (auto const &element : { elements[0], elements[1] }) {
+        REQUIRE(element.is_borrowed_string());
+        auto str = string_cast(element);
+        REQUIRE(str.data() > json.data());
+        REQUIRE(str.c_str()[str.length()] == 0);
+    }
+    REQUIRE(std::string(string_cast(elements[0]).c_str()) == "plain");
+    REQUIRE(std::string(string_cast(elements[1]).c_str()) ==
+            "tab\tand \xC3\xA9");
+
+    // error lines are not thrown off by unescaped line feeds
+    std::string invalid = "[\"a\\nb\\nc\",\n1,]";
+    try {
+        parse_insitu(&invalid[0], invalid.size());
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_line() == 2);
+    }
+}
+
+TEST_CASE("document") {
+
+    using namespace ujson;
+
+    document doc;
+    REQUIRE(doc.root().is_null());
+    REQUIRE(doc.capacity() == 0);
+
+    // same value as parse, with strings in the arena
+    const std::string json =
+        "{\"z\":[1,\"two\",{\"b\":null,\"a\":[]}],\"a\":\"x\\ty\","
+        "\"m\":\"a string longer than the short string buffer\",\"a\":2}";
+    auto const &root = doc.parse(json);
+    REQUIRE(&root == &doc.root());
+    REQUIRE(root == parse(json));
+    REQUIRE(to_string(root) == to_string(parse(json)));
+    auto m = find(object_cast(root), "m");
+    REQUIRE(m->second.is_borrowed_string());
+    REQUIRE(std::string(string_cast(m->second).c_str()) ==
+            "a string longer than the short string buffer");
+
+    // duplicate names keep their order
+    auto const &members = object_cast(root);
+    REQUIRE(members[0].first == "a");
+    REQUIRE(members[0].second == value("x\ty"));
+    REQUIRE(members[1].second == value(2));
+
+    // a large document merges the arena into one chunk for the next parse
+    std::string large = "[";
+    for (int i = 0; i < 10000; ++i)
+        large += "[\"element\"],";
+    large += "{}]";
+    REQUIRE(array_cast(doc.parse(large)).size() == 10001);
+    auto const capacity = doc.capacity();
+    REQUIRE(capacity > 4096);
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(array_cast(doc.parse(large)).size() == 10001);
+    REQUIRE(doc.capacity() == capacity);
+
+    // borrowed strings refer to the input instead
+    parse_options opts;
+    opts.borrowed_strings = true;
+    auto const &borrowed = doc.parse(json, opts);
+    m = find(object_cast(borrowed), "m");
+    REQUIRE(string_cast(m->second).data() > json.data());
+
+    // failed parses leave the document null
+    REQUIRE_THROWS(doc.parse("[1,2"));
+    REQUIRE(doc.root().is_null());
+    REQUIRE_THROWS(doc.parse("[1] 2"));
+    REQUIRE(doc.parse("[1]") == parse("[1]"));
+}
+
+TEST_CASE("tape") {
+
+    using namespace ujson;
+
+    tape t;
+    REQUIRE(t.root().type() == value_type::null);
+
+    const std::string json =
+        "{\"b\":[null,true,false,-1,18446744073709551615,0.5,\"s\\u00e9\"],"
+        "\"a\":{\"x\":[[],{}],\"y\":\"z\"},\"c\":9007199254740993}";
+    auto root = t.parse(json);
+    REQUIRE(to_value(root) == parse(json));
+    REQUIRE(to_value(t.root()) == parse(json));
+
+    // members keep input order
+    auto obj = object_cast(root);
+    REQUIRE(obj.size() == 3);
+    std::string names;
+    for (auto member : obj)
+        names += std::string(member.first);
+    REQUIRE(names == "bac");
+
+    // scalars
+    auto b = array_cast((*find(obj, "b")).second);
+    REQUIRE(b.size() == 7);
+    REQUIRE(b[0].type() == value_type::null);
+    REQUIRE(bool_cast(b[1]));
+    REQUIRE_FALSE(bool_cast(b[2]));
+    REQUIRE(int64_cast(b[3]) == -1);
+    REQUIRE(double_cast(b[3]) == -1.0);
+    REQUIRE(uint64_cast(b[4]) == std::numeric_limits<std::uint64_t>::max());
+    REQUIRE_THROWS(int64_cast(b[4]));
+    REQUIRE(double_cast(b[5]) == 0.5);
+    auto str = string_cast(b[6]);
+    REQUIRE(std::string(str.c_str()) == "s\xC3\xA9");
+    REQUIRE(int64_cast((*find(obj, "c")).second) == 9007199254740993);
+
+    // nested containers are skipped over
+    auto a = object_cast((*find(obj, "a")).second);
+    auto x = array_cast((*find(a, "x")).second);
+    REQUIRE(x.size() == 2);
+    REQUIRE(array_cast(x[0]).empty());
+    REQUIRE(object_cast(x[1]).empty());
+    REQUIRE(std::string(string_cast((*find(a, "y")).second)) == "z");
+    REQUIRE(find(a, "missing") == a.end());
+
+    std::size_t count = 0;
+    for (auto it = b.begin(); it != b.end(); it++)
+        ++count;
+    REQUIRE(count == b.size());
+
+    // wrong types
+    REQUIRE_THROWS(array_cast(root));
+    REQUIRE_THROWS(string_cast(b[3]));
+    REQUIRE_THROWS(bool_cast(b[0]));
+
+    // scalars at the top level, and failed parses leave the tape empty
+    REQUIRE(string_cast(t.parse("\"top\"")).length() == 3);
+    REQUIRE(t.size() == 2);
+    REQUIRE_THROWS(t.parse("[1,2"));
+    REQUIRE(t.size() == 0);
+    REQUIRE(t.root().type() == value_type::null);
+    REQUIRE_THROWS(t.parse("1 2"));
+
+    // object names are stored once per tape, string values are not
+    std::string records = "[";
+    for (int i = 0; i < 100; ++i)
+        records += "{\"id\":" + std::to_string(i) + ",\"k" +
+                   std::to_string(i) + "\":\"id\",\"a\\u0000b\":1,\"a\":2},";
+    records.back() = ']';
+    auto items = array_cast(t.parse(records));
+    REQUIRE(to_value(t.root()) == parse(records));
+    auto first = object_cast(items[0]);
+    auto last = object_cast(items[99]);
+    REQUIRE((*first.begin()).first.data() == (*last.begin()).first.data());
+    REQUIRE(string_cast((*find(first, "k0")).second).data() !=
+            string_cast((*find(last, "k99")).second).data());
+    REQUIRE((*find(last, "a")).first.length() == 1);
+    REQUIRE(int64_cast((*find(last, "a")).second) == 2);
+    REQUIRE(find(last, (*first.begin()).first.data()) == last.begin());
+    REQUIRE(to_value(t.parse("{\"x\":{\"x\":1}}")) ==
+            parse("{\"x\":{\"x\":1}}"));
+}
+
+TEST_CASE("max_depth") {
+
+    using namespace ujson;
+
+    auto nested = [](std::size_t depth, const char *open, const char *close) {
+        std::string json;
+        for (std::size_t i = 0; i < depth; ++i)
+            json += open;
+        json += "0";
+        for (std::size_t i = 0; i < depth; ++i)
+            json += close;
+        return json;
+    };
+
+    auto too_deep = [](std::function<void()> f) {
+        try {
+            f();
+        } catch (const exception &e) {
+            return e.get_error_code() == error_code::too_deep;
+        }
+        return false;
+    };
+
+    // up to the default limit of 1024 levels
+    auto arrays = nested(1024, "[", "]");
+    auto objects = nested(1024, "{\"a\":", "}");
+    REQUIRE(to_string(parse(arrays), compact_ascii) == arrays);
+    REQUIRE(to_string(parse(objects), compact_ascii) == objects);
+    document doc;
+    REQUIRE(doc.parse(objects) == parse(objects));
+    tape t;
+    REQUIRE(to_value(t.parse(arrays)) == parse(arrays));
+    handler h;
+    parse(objects, h);
+
+    // one more fails
+    auto deeper = nested(1025, "[", "]");
+    REQUIRE(too_deep([&] { parse(deeper); }));
+    REQUIRE(too_deep([&] { parse(nested(1025, "{\"a\":", "}")); }));
+    REQUIRE(too_deep([&] { doc.parse(deeper); }));
+    REQUIRE(too_deep([&] { t.parse(deeper); }));
+    REQUIRE(too_deep([&] { parse(deeper, h); }));
+    REQUIRE(too_deep([&] {
+        incremental_parser parser;
+        parser.feed(deeper.data(), deeper.size());
+        parser.finish();
+    }));
+
+    // empty containers count too
+    parse_options opts;
+    opts.max_depth = 2;
+    REQUIRE(parse("[[]]", opts) == parse("[[]]"));
+    REQUIRE(too_deep([&] { parse("[[[]]]", opts); }));
+    REQUIRE(too_deep([&] { parse("[{},[{}]]", opts); }));
+    opts.max_depth = 0;
+    REQUIRE(parse("1", opts) == value(1));
+    REQUIRE(too_deep([&] { parse("[]", opts); }));
+
+    // nesting far deeper than the thread stack allows, without a tree
+    auto huge = nested(1000000, "[", "]");
+    opts.max_depth = 1000000;
+    reader r(huge.data(), huge.size());
+    r.skip_value();
+    REQUIRE(r.read_token() == token::eof);
+    parse(huge.data(), huge.size(), h, opts);
+    REQUIRE(t.parse(huge.data(), huge.size(), opts).type() ==
+            value_type::array);
+    auto mixed = nested(10000, "[{\"a\":", "}]");
+    opts.max_depth = 20000;
+    bool same = to_value(t.parse(mixed.data(), mixed.size(), opts)) ==
+                parse(mixed.data(), mixed.size(), opts);
+    REQUIRE(same);
+    REQUIRE(too_deep([&] { parse(huge); }));
+
+    // still checks the syntax
+    for (auto invalid : { "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}",
+                          "[}", "{]", "[[1]", "{\"a\":[1}", "[,1]" }) {
+        REQUIRE_THROWS(parse(invalid));
+        REQUIRE_THROWS(doc.parse(invalid));
+        REQUIRE_THROWS(t.parse(invalid));
+        REQUIRE_THROWS(parse(invalid, h));
+        REQUIRE_THROWS([&] {
+            reader r(invalid);
+            r.skip_value();
+        }());
+    }
+}
+
+TEST_CASE("parse_many") {
+
+    using namespace ujson;
+
+    // newline delimited and concatenated values, with their offsets
+    const std::string ndjson = "{\"a\":1}\n[2, 3]\n\n\"four\"\r\n5 6{}[]";
+    array values;
+    std::vector<std::size_t> offsets;
+    auto stream = parse_many(ndjson.data(), ndjson.size());
+    value v;
+    while (stream.next(v)) {
+        values.push_back(v);
+        offsets.push_back(stream.offset());
+    }
+    REQUIRE(value(values) ==
+            parse("[{\"a\":1},[2,3],\"four\",5,6,{},[]]"));
+    const std::vector<std::size_t> expected = { 0, 8, 16, 24, 26, 27, 29 };
+    REQUIRE(offsets == expected);
+    REQUIRE_FALSE(stream.next(v));
+    REQUIRE(stream.skipped() == 0);
+
+    // empty or blank input
+    REQUIRE_FALSE(parse_many("").next(v));
+    REQUIRE_FALSE(parse_many(" \n ").next(v));
+
+    // invalid lines throw, or are skipped, and reading resumes on the
+    // next line
+    const std::string invalid = "1\n[2,\n{\"a\"}\n@\n\"ok\"";
+    value_stream throwing(invalid.data(), invalid.size());
+    REQUIRE(throwing.next(v));
+    try {
+        throwing.next(v);
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_line() == 3);
+        REQUIRE(throwing.offset() == 2);
+    }
+    REQUIRE_THROWS(throwing.next(v));
+    REQUIRE_THROWS(throwing.next(v));
+    REQUIRE(throwing.next(v));
+    REQUIRE(v == value("ok"));
+
+    value_stream skipping(invalid.data(), invalid.size(), skip_invalid::yes);
+    values.clear();
+    while (skipping.next(v))
+        values.push_back(v);
+    REQUIRE(value(values) == parse("[1,\"ok\"]"));
+    REQUIRE(skipping.skipped() == 3);
+
+    // a zero byte between values is an error, not the end of the input
+    const std::string zero("1\n\0\n2", 5);
+    value_stream zero_throwing(zero.data(), zero.size());
+    REQUIRE(zero_throwing.next(v));
+    REQUIRE_THROWS(zero_throwing.next(v));
+    REQUIRE(zero_throwing.offset() == 2);
+    REQUIRE(zero_throwing.next(v));
+    REQUIRE(v == 2);
+
+    value_stream zero_skipping(zero.data(), zero.size(), skip_invalid::yes);
+    values.clear();
+    while (zero_skipping.next(v))
+        values.push_back(v);
+    REQUIRE(value(values) == parse("[1,2]"));
+    REQUIRE(zero_skipping.skipped() == 1);
+
+    // options apply to every value
+    parse_options opts;
+    opts.max_depth = 1;
+    auto nested = parse_many("[1]\n[[2]]\n[3]", 0, skip_invalid::yes, opts);
+    values.clear();
+    while (nested.next(v))
+        values.push_back(v);
+    REQUIRE(value(values) == parse("[[1],[3]]"));
+}
+
+TEST_CASE("parallel_value_stream") {
+
+    using namespace ujson;
+
+    std::string ndjson;
+    for (int i = 0; i < 5000; ++i)
+        ndjson += "{\"id\":" + std::to_string(i) + ",\"tags\":[\"a\",\"b\"]}\n";
+
+    auto read_all = [](parallel_value_stream &stream,
+                       std::vector<std::size_t> &offsets) {
+        array values;
+        value v;
+        while (stream.next(v)) {
+            values.push_back(v);
+            offsets.push_back(stream.offset());
+        }
+        return values;
+    };
+
+    array expected;
+    std::vector<std::size_t> expected_offsets;
+    auto sequential = parse_many(ndjson.data(), ndjson.size());
+    value v;
+    while (sequential.next(v)) {
+        expected.push_back(v);
+        expected_offsets.push_back(sequential.offset());
+    }
+
+    // same values and offsets as parse_many, whatever the chunking
+    for (unsigned threads : { 1, 4 }) {
+        for (std::size_t chunk_size : { 1, 100, 1 << 20 }) {
+            for (std::size_t max_chunks : { 1, 0 }) {
+                parallel_options parallel;
+                parallel.threads = threads;
+                parallel.chunk_size = chunk_size;
+                parallel.max_chunks = max_chunks;
+                parallel_value_stream stream(ndjson.data(), ndjson.size(),
+                                             skip_invalid::no,
+                                             parse_options(), parallel);
+                std::vector<std::size_t> offsets;
+                REQUIRE(read_all(stream, offsets) == expected);
+                REQUIRE(offsets == expected_offsets);
+            }
+        }
+    }
+
+    // unordered returns each value once
+    parallel_options unordered;
+    unordered.threads = 4;
+    unordered.chunk_size = 1000;
+    unordered.ordered = false;
+    parallel_value_stream stream(ndjson.data(), ndjson.size(),
+                                 skip_invalid::no, parse_options(),
+                                 unordered);
+    std::vector<std::size_t> offsets;
+    auto values = read_all(stream, offsets);
+    REQUIRE(values.size() == expected.size());
+    std::sort(offsets.begin(), offsets.end());
+    REQUIRE(offsets == expected_offsets);
+
+    // invalid lines throw with their line in the whole buffer, or are
+    // skipped
+    const std::string invalid = "1\n2\n[3,\n4\n{5}\n6\n";
+    parallel_options small;
+    small.chunk_size = 1;
+    parallel_value_stream throwing(invalid.data(), invalid.size(),
+                                   skip_invalid::no, parse_options(), small);
+    REQUIRE(throwing.next(v));
+    REQUIRE(throwing.next(v));
+    try {
+        throwing.next(v);
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_line() == 4);
+        REQUIRE(throwing.offset() == 4);
+    }
+    REQUIRE(throwing.next(v));
+    REQUIRE(v == value(4));
+    REQUIRE_THROWS(throwing.next(v));
+    REQUIRE(throwing.next(v));
+    REQUIRE(v == value(6));
+    REQUIRE_FALSE(throwing.next(v));
+
+    parallel_value_stream skipping(invalid.data(), invalid.size(),
+                                   skip_invalid::yes, parse_options(), small);
+    offsets.clear();
+    REQUIRE(value(read_all(skipping, offsets)) == parse("[1,2,4,6]"));
+    REQUIRE(skipping.skipped() == 2);
+
+    // empty input, and stopping early
+    REQUIRE_FALSE(parallel_value_stream("").next(v));
+    parallel_value_stream early(ndjson.data(), ndjson.size(),
+                                skip_invalid::no, parse_options(), small);
+    REQUIRE(early.next(v));
+}
+
+TEST_CASE("parse_parallel") {
+
+    using namespace ujson;
+
+    // strings with brackets, commas and escaped quotes, which must not split
+    std::string array_json = "[\n";
+    std::string object_json = "{\n";
+    for (int i = 0; i < 2000; ++i) {
+        auto n = std::to_string(i);
+        auto member = "{\"id\":" + n + ",\"s\":\"],[\\\\\\\",{" + n +
+                      "\",\"a\":[[" + n + "],{}]}";
+        array_json += (i ? ",\n" : "") + member;
+        object_json += (i ? ",\n\"k" : "\"k") + n + "\":" + member;
+    }
+    array_json += "\n]";
+    object_json += "\n}";
+
+    // same value as parse, whatever the chunking
+    for (auto json : { &array_json, &object_json }) {
+        auto expected = parse(*json);
+        for (std::size_t chunk_size : { 1, 7, 100, 1 << 20 }) {
+            parallel_options parallel;
+            parallel.threads = 4;
+            parallel.chunk_size = chunk_size;
+            REQUIRE(parse_parallel(json->data(), json->size(),
+                                   parse_options(), parallel) == expected);
+        }
+    }
+    parallel_options small;
+    small.threads = 4;
+    small.chunk_size = 2;
+    REQUIRE(parse_parallel(" [ ] ", 0, parse_options(), small) == array());
+    REQUIRE(parse_parallel("[1,[2,3],4]", 0, parse_options(), small) ==
+            parse("[1,[2,3],4]"));
+    REQUIRE(parse_parallel("\"[1,2]\"", 0, parse_options(), small) ==
+            value("[1,2]"));
+
+    // invalid input throws as parse does
+    for (auto json : { "[1,,2]", "[1,2,]", "[1\n,2\n,\"3]", "[1,2]]",
+                       "{\"a\":1,\n\"b\"}", "[1,\n[2,3}]", "[1,2] x" }) {
+        try {
+            parse(json);
+            FAIL();
+        } catch (const exception &expected) {
+            try {
+                parse_parallel(json, 0, parse_options(), small);
+                FAIL();
+            } catch (const exception &e) {
+                REQUIRE(e.get_error_code() == expected.get_error_code());
+                REQUIRE(e.get_line() == expected.get_line());
+            }
+        }
+    }
+
+    // the top-level container counts towards max_depth
+    parse_options shallow;
+    shallow.max_depth = 2;
+    REQUIRE(parse_parallel("[[1],[2]]", 0, shallow, small) ==
+            parse("[[1],[2]]"));
+    REQUIRE_THROWS(parse_parallel("[[1],[[2]]]", 0, shallow, small));
+}
+
+TEST_CASE("try_parse") {
+
+    using namespace ujson;
+
+    value v;
+    parse_error error;
+    REQUIRE(try_parse("[1, {\"a\" : true}]", 0, v, error));
+    REQUIRE(v == parse("[1,{\"a\":true}]"));
+
+    // errors give the offset, line and column of the token at fault, and
+    // leave the result unchanged
+    struct {
+        const char *json;
+        error_code code;
+        std::size_t offset;
+        int line;
+        int column;
+    } const cases[] = {
+        { "", error_code::invalid_syntax, 0, 1, 1 },
+        { "[1,\n 2,\n  x]", error_code::invalid_syntax, 10, 3, 3 },
+        { "{\"a\" : 1,\n}", error_code::invalid_syntax, 10, 2, 1 },
+        { "[1, 2", error_code::invalid_syntax, 5, 1, 6 },
+        { "[\n1e999]", error_code::bad_number, 2, 2, 1 },
+        { "\"ab\ncd\"", error_code::invalid_syntax, 0, 1, 1 },
+        { "[1] 2", error_code::invalid_syntax, 4, 1, 5 },
+        { "{\"a\" 1}", error_code::invalid_syntax, 5, 1, 6 },
+        { "{1 : 2}", error_code::invalid_syntax, 1, 1, 2 },
+        { "[1e999, x]", error_code::bad_number, 1, 1, 2 },
+    };
+    for (auto &c : cases) {
+        REQUIRE_FALSE(try_parse(c.json, std::strlen(c.json), v, error));
+        REQUIRE(error.code == c.code);
+        REQUIRE(error.offset == c.offset);
+        REQUIRE(error.line == c.line);
+        REQUIRE(error.column == c.column);
+    }
+    REQUIRE(v == parse("[1,{\"a\":true}]"));
+
+    parse_options shallow;
+    shallow.max_depth = 1;
+    REQUIRE_FALSE(try_parse(std::string("[[1]]"), v, error, shallow));
+    REQUIRE(error.code == error_code::too_deep);
+    REQUIRE(error.offset == 1);
+
+    // the reader keeps the first error and returns eof after a syntax error
+    reader reader("[1e999, 1 x 2]");
+    reader.record_errors();
+    REQUIRE(reader.read_token() == token::array_begin);
+    REQUIRE(reader.read_token() == token::number);
+    reader.read_double();
+    REQUIRE(reader.failed());
+    REQUIRE(reader.read_token() == token::comma);
+    REQUIRE(reader.read_token() == token::number);
+    REQUIRE(reader.read_token() == token::eof);
+    REQUIRE(reader.read_token() == token::eof);
+    REQUIRE(reader.error() == error_code::bad_number);
+    REQUIRE(reader.error_offset() == 1);
+}
+
+TEST_CASE("parse_projected") {
+
+    using namespace ujson;
+
+    const std::string json = "{ \"user\" : { \"id\" : 7, \"name\" : \"a]\\\"}\" },"
+                             "  \"items\" : [ { \"price\" : 1.5, \"sku\" : \"x\" },"
+                             "                { \"sku\" : \"y\" },"
+                             "                { \"price\" : 3, \"tags\" : [ 1 ] },"
+                             "                4 ],"
+                             "  \"a/b\" : { \"~\" : true }, \"skipped\" : [ { } ] }";
+
+    REQUIRE(parse_projected(json, { "/user/id" }) ==
+            parse("{\"user\":{\"id\":7}}"));
+    REQUIRE(parse_projected(json, { "/user/id", "/items/*/price" }) ==
+            parse("{\"user\":{\"id\":7},"
+                  "\"items\":[{\"price\":1.5},{},{\"price\":3}]}"));
+    REQUIRE(parse_projected(json, { "" }) == parse(json));
+    REQUIRE(parse_projected(json, { "/user" }) ==
+            parse("{\"user\":{\"id\":7,\"name\":\"a]\\\"}\"}}"));
+    REQUIRE(parse_projected(json, { "/a~1b/~0" }) ==
+            parse("{\"a/b\":{\"~\":true}}"));
+
+    // elements keep their index; a named index and "*" combine
+    REQUIRE(parse_projected(json, { "/items/2/tags", "/items/1" }) ==
+            parse("{\"items\":[null,{\"sku\":\"y\"},{\"tags\":[1]}]}"));
+    REQUIRE(parse_projected(json, { "/items/*/sku", "/items/2/price" }) ==
+            parse("{\"items\":[{\"sku\":\"x\"},{\"sku\":\"y\"},"
+                  "{\"price\":3}]}"));
+
+    // paths that do not match select nothing
+    REQUIRE(parse_projected(json, { "/user/id/x", "/missing" }) ==
+            parse("{\"user\":{}}"));
+    REQUIRE(parse_projected("[1, 2]", { "/x" }) == array());
+    REQUIRE(parse_projected("{\"a\":[[1,2],[3]],\"b\":1}", { "/a/x" }) ==
+            parse("{\"a\":[]}"));
+    REQUIRE(parse_projected("{\"a\":[{\"q\":1},{\"r\":2}],\"b\":1}",
+                            { "/a/x" }) == parse("{\"a\":[]}"));
+    REQUIRE(parse_projected("[\"]\", [1]]", { "/x" }) == array());
+    REQUIRE_THROWS(parse_projected("[[1, 2]", { "/x" }));
+    REQUIRE(parse_projected("1", { "/x" }) == null);
+
+    // skipped values are only checked for matching brackets and quotes,
+    // but the selected ones and the structure around them are parsed
+    REQUIRE(parse_projected("{\"a\":1,\"b\":[nul]}", { "/a" }) ==
+            parse("{\"a\":1}"));
+    REQUIRE_THROWS(parse_projected("{\"a\":1,\"b\":[[]}", { "/a" }));
+    REQUIRE_THROWS(parse_projected("{\"a\":nul,\"b\":1}", { "/a" }));
+    REQUIRE_THROWS(parse_projected("{\"b\":1,\"a\":1} x", { "/a" }));
+    REQUIRE_THROWS(projection({ "a" }));
+
+    parse_options shallow;
+    shallow.max_depth = 2;
+    REQUIRE_THROWS(parse_projected("[[[1]]]", { "/0/0/0" }, shallow));
+    REQUIRE(parse_projected("[[[1]]]", { "/0/0/0" }) ==
+            parse("[[[1]]]"));
+}
+
+TEST_CASE("parse_prefix") {
+
+    using namespace ujson;
+
+    std::size_t consumed = 0;
+    const char json[] = " [1, {\"a\": 2}] trailing";
+    REQUIRE(parse_prefix(json, sizeof(json) - 1, consumed) ==
+            parse("[1,{\"a\":2}]"));
+    REQUIRE(consumed == 14);
+    REQUIRE(parse_prefix("12 34", 0, consumed) == value(12));
+    REQUIRE(consumed == 2);
+    REQUIRE(parse_prefix("\"s\"x", 0, consumed) == value("s"));
+    REQUIRE(consumed == 3);
+    REQUIRE_THROWS(parse_prefix("[1", 0, consumed));
+    REQUIRE_THROWS(parse_prefix("", 0, consumed));
+}
+
+TEST_CASE("incremental") {
+
+    using namespace ujson;
+
+    const std::string json =
+        "{ \"a\" : [ 1, -2.5e-3, true, false, null ],\n"
+        "  \"b\" : \"esc \\\" \\\\ \\u00e6 \\uD83C\\uDF7B\",\n"
+        "  \"c\" : \"R\xC3\xB8""dgr\xC3\xB8""d \xF0\x9F\x8D\xBB\",\n"
+        "  \"d\" : { \"e\" : [ [], {} ], \"f\" : 123456789012 } }";
+    const auto expected = parse(json);
+
+    // split in two at every possible position
+    for (std::size_t i = 0; i <= json.length(); ++i) {
+        incremental_parser parser;
+        parser.feed(json.data(), i);
+        parser.feed(json.data() + i, json.length() - i);
+        REQUIRE(parser.finish() == expected);
+    }
+
+    // one byte at a time, reusing the parser
+    incremental_parser parser;
+    for (int n = 0; n < 2; ++n) {
+        for (char c : json)
+            parser.feed(&c, 1);
+        REQUIRE(parser.finish() == expected);
+    }
+
+    // top level scalars may continue until finish
+    parser.feed("12", 2);
+    parser.feed("34", 2);
+    REQUIRE(parser.finish() == 1234);
+    parser.feed(" tr", 3);
+    parser.feed("ue ", 3);
+    REQUIRE(parser.finish() == true);
+
+    // random documents in random chunk sizes
+    auto random = to_string(gen_object(0));
+    auto random_expected = parse(random);
+    for (std::size_t i = 0; i < random.length();) {
+        auto len = std::min<std::size_t>(1 + marsaglia_mwc() % 4096,
+                                         random.length() - i);
+        parser.feed(random.data() + i, len);
+        i += len;
+    }
+    REQUIRE(parser.finish() == random_expected);
+
+    // errors
+    parser.feed("[ 1, ", 5);
+    REQUIRE_THROWS(parser.finish());
+    parser.feed("[ 1,", 4);
+    REQUIRE_THROWS(parser.feed(" ]", 2));
+    parser.feed("\"\xC3", 2);
+    REQUIRE_THROWS(parser.feed("\x28\"", 2));
+    REQUIRE_THROWS(parser.feed("1 2 ", 4));
+    REQUIRE_THROWS(parser.finish());
+    parser.feed("[\n1,\n", 5);
+    try {
+        parser.feed("2 3 ]", 5);
+        REQUIRE(false);
+    } catch (exception const &e) {
+        REQUIRE(e.get_line() == 3);
+    }
+
+    // options apply across chunks and after a reset
+    parse_options opts;
+    opts.max_depth = 2;
+    opts.raw_numbers = true;
+    incremental_parser limited(opts);
+    limited.feed("[[1.50", 6);
+    limited.feed("0]]", 3);
+    auto v = limited.finish();
+    REQUIRE(v == parse("[[1.500]]", opts));
+    REQUIRE(std::string(raw_number_cast(array_cast(array_cast(v)[0])[0])) ==
+            "1.500");
+    REQUIRE_THROWS(limited.feed("[[[", 3));
+    limited.feed("[", 1);
+    try {
+        limited.feed("[[", 2);
+        REQUIRE(false);
+    } catch (exception const &e) {
+        REQUIRE(e.get_error_code() == error_code::too_deep);
+    }
+}
+
+TEST_CASE("array_stream") {
+
+    using namespace ujson;
+
+    // large enough to span several chunks
+    array elements;
+    for (int i = 0; i < 200; ++i)
+        elements.push_back(gen_object(2));
+    const auto json = to_string(elements);
+
+    std::istringstream stream(json);
+    array_stream reader(stream);
+    value v;
+    std::size_t n = 0;
+    while (reader.next(v)) {
+        REQUIRE(n < elements.size());
+        REQUIRE(v == elements[n++]);
+    }
+    REQUIRE(n == elements.size());
+    REQUIRE(!reader.next(v));
+
+    {
+        std::ofstream file("array_stream.json", std::ios::binary);
+        file << "[ 1, \"two\", [ 3 ], { \"four\" : 4 } ]";
+    }
+    {
+        array_stream file_reader(std::string("array_stream.json"));
+        array result;
+        while (file_reader.next(v))
+            result.push_back(std::move(v));
+        REQUIRE(value(result) == parse("[1,\"two\",[3],{\"four\":4}]"));
+    }
+    std::remove("array_stream.json");
+
+    std::istringstream empty("[]");
+    REQUIRE(!array_stream(empty).next(v));
+
+    // errors
+    REQUIRE_THROWS(array_stream(std::string("does_not_exist.json")));
+    std::istringstream not_array("{ \"a\" : 1 }");
+    REQUIRE_THROWS(array_stream(not_array).next(v));
+    std::istringstream truncated("[ 1, 2, [");
+    array_stream truncated_reader(truncated);
+    REQUIRE((truncated_reader.next(v) && v == 1));
+    REQUIRE((truncated_reader.next(v) && v == 2));
+    REQUIRE_THROWS(truncated_reader.next(v));
+
+    // elements before an error in the same chunk come first, and the
+    // stream ends with the error
+    std::istringstream invalid("[1,2,x,3]");
+    array_stream invalid_reader(invalid);
+    REQUIRE((invalid_reader.next(v) && v == 1));
+    REQUIRE((invalid_reader.next(v) && v == 2));
+    REQUIRE_THROWS(invalid_reader.next(v));
+    REQUIRE(!invalid_reader.next(v));
+
+    // streams that fail without reaching eof
+    std::ifstream missing("does_not_exist.json");
+    array_stream missing_reader(missing);
+    try {
+        missing_reader.next(v);
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_error_code() == error_code::io_error);
+    }
+    REQUIRE(!missing_reader.next(v));
+    std::istringstream failed("[1]");
+    failed.setstate(std::ios::failbit);
+    REQUIRE_THROWS(array_stream(failed).next(v));
+}
+
+TEST_CASE("parse_file") {
+
+    using namespace ujson;
+
+    auto write = [](const std::string &content) {
+        std::ofstream file("parse_file.json", std::ios::binary);
+        file << content;
+    };
+
+    // sizes with room for padding in the last page, without room, and
+    // ending on a page boundary
+    std::string json = "{ \"name\" : \"file\", \"values\" : [ 1, 2.5 ] }";
+    for (std::size_t size : { std::size_t(0), std::size_t(4090),
+                              std::size_t(4096), std::size_t(8192) }) {
+        write(json + std::string(size > json.size() ? size - json.size()
+                                                     : 0, ' '));
+        REQUIRE(parse_file("parse_file.json") == parse(json));
+    }
+
+    // strings are copied out of the mapping
+    parse_options borrowed;
+    borrowed.borrowed_strings = true;
+    auto v = parse_file("parse_file.json", borrowed);
+    auto name = find(object_cast(v), "name");
+    REQUIRE_FALSE(name->second.is_borrowed_string());
+
+    // errors
+    write("[ 1,\n 2");
+    try {
+        parse_file("parse_file.json");
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_error_code() == error_code::invalid_syntax);
+        REQUIRE(e.get_line() == 2);
+    }
+    write("");
+    try {
+        parse_file("parse_file.json");
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_error_code() == error_code::invalid_syntax);
+        REQUIRE(e.get_line() == 1);
+    }
+    std::remove("parse_file.json");
+    try {
+        parse_file("does_not_exist.json");
+        FAIL();
+    } catch (const exception &e) {
+        REQUIRE(e.get_error_code() == error_code::io_error);
+    }
+}
+
 TEST_CASE("performance", "[hide]") {
     
     using namespace ujson;
@@ -25,7 +25,17 @@
 #include "double-conversion.h"
 
 #include <algorithm>
-#include <sstream>
+#include <atomic>
+#include <bitset>
+#include <cfloat>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
 
 #ifdef __GNUC__
 #ifdef __SSE2__
@@ -45,6 +55,25 @@
 #include <emmintrin.h>
 #endif
 
+#if defined _MSC_VER && (defined(_M_AMD64) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // vs2013 ctp 1 supports noexcept but rest don't
 #if defined _MSC_VER && _MSC_FULL_VER != 180021114
 #define noexcept
@@ -52,6 +81,701 @@
 
 const ujson::value ujson::null = ujson::value();
 
+// --------------------------------------------------------------------------
+// simd kernels
+//
+// The inner loops of the scanner and serializer come in scalar, sse2, avx2
+// and avx-512 versions. The best version supported by the cpu is selected
+// at startup, so the same binary uses wider vectors where available.
+
+#if defined UJSON_USE_SSE2 && defined __GNUC__ &&                           \
+    (__GNUC__ >= 6 || defined __clang__)
+#define UJSON_USE_AVX
+#define UJSON_TARGET(isa) __attribute__((target(isa)))
+#elif defined UJSON_USE_SSE2 && defined _MSC_VER && _MSC_VER >= 1910 &&    \
+    (defined(_M_AMD64) || defined(_M_X64))
+#define UJSON_USE_AVX
+#define UJSON_TARGET(isa)
+#endif
+
+#ifdef UJSON_USE_AVX
+#include <immintrin.h>
+#endif
+
+// index of lowest set bit; x must be non-zero
+static int trailing_zeros(std::uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#elif defined _MSC_VER && (defined(_M_AMD64) || defined(_M_X64))
+    unsigned long index = 0;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+static std::size_t utf8_length(const std::uint8_t *ptr,
+                               const std::uint8_t *end);
+
+namespace {
+
+// one bit per byte of a 64 byte block
+struct block_bits {
+    std::uint64_t whitespace;
+    std::uint64_t quotes;
+    std::uint64_t special; // backslash and control bytes
+    std::uint64_t non_ascii;
+};
+
+// kernels may write up to len bytes to out, also past the returned length
+struct kernel_table {
+    ujson::simd_level level;
+
+    // classify 64 bytes
+    block_bits (*classify)(const std::uint8_t *block);
+
+    // true if valid utf-8
+    bool (*validate_utf8)(const char *ptr, std::size_t len);
+
+    // copy bytes up to the first one that must be escaped in a JSON
+    // string; with ascii set that includes non-ascii bytes
+    std::size_t (*copy_plain)(const char *in, std::size_t len, char *out,
+                              bool ascii);
+};
+}
+
+// the scalar kernels work on eight bytes at a time in a 64 bit word (simd
+// within a register); each byte of a mask has its high bit set or clear
+
+const std::uint64_t ones = 0x0101010101010101;
+const std::uint64_t high_bits = 0x8080808080808080;
+
+// eight bytes as a little endian word, so byte i is bits 8i..8i+7
+static std::uint64_t load_word(const void *ptr) {
+    std::uint64_t x;
+    std::memcpy(&x, ptr, sizeof(x));
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+// high bit set in exactly the zero bytes of x; unlike the usual
+// (x - ones) & ~x & high_bits no borrow spills into the following bytes
+static std::uint64_t zero_bytes(std::uint64_t x) {
+    const std::uint64_t low_bits = ~high_bits;
+    return ~(((x & low_bits) + low_bits) | x) & high_bits;
+}
+
+// high bit set in the bytes of x equal to c
+static std::uint64_t equal_bytes(std::uint64_t x, std::uint8_t c) {
+    return zero_bytes(x ^ (ones * c));
+}
+
+// high bit set in the bytes of x less than 0x20
+static std::uint64_t control_bytes(std::uint64_t x) {
+    return zero_bytes(x & (ones * 0xE0));
+}
+
+// gather the high bits of a mask into the low eight bits
+static std::uint64_t pack_mask(std::uint64_t mask) {
+    return ((mask >> 7) * 0x0102040810204080) >> 56;
+}
+
+static block_bits classify_scalar(const std::uint8_t *ptr) {
+    block_bits bits = { 0, 0, 0, 0 };
+    for (int i = 0; i < 8; ++i) {
+        const auto x = load_word(ptr + 8 * i);
+        const auto whitespace = equal_bytes(x, 0x20) | equal_bytes(x, 0x09) |
+                                equal_bytes(x, 0x0A) | equal_bytes(x, 0x0D);
+        const auto special = equal_bytes(x, '\\') | control_bytes(x);
+
+        const int shift = 8 * i;
+        bits.whitespace |= pack_mask(whitespace) << shift;
+        bits.quotes |= pack_mask(equal_bytes(x, '"')) << shift;
+        bits.special |= pack_mask(special) << shift;
+        bits.non_ascii |= pack_mask(x & high_bits) << shift;
+    }
+    return bits;
+}
+
+static std::size_t ascii_length_scalar(const char *ptr, std::size_t len) {
+    std::size_t n = 0;
+    for (; len - n >= 8; n += 8) {
+        const auto mask = load_word(ptr + n) & high_bits;
+        if (mask)
+            return n + trailing_zeros(mask) / 8;
+    }
+    while (n < len && static_cast<std::uint8_t>(ptr[n]) < 0x80)
+        ++n;
+    return n;
+}
+
+// validate one sequence at a time with the range table, skipping runs of
+// ascii with ascii_length
+template <std::size_t (*ascii_length)(const char *, std::size_t)>
+static bool validate_utf8_ranges(const char *ptr, std::size_t len) {
+    const auto end = ptr + len;
+    while (ptr < end) {
+        ptr += ascii_length(ptr, end - ptr);
+        if (ptr == end)
+            break;
+
+        const auto length =
+            utf8_length(reinterpret_cast<const std::uint8_t *>(ptr),
+                        reinterpret_cast<const std::uint8_t *>(end));
+        if (!length)
+            return false;
+        ptr += length;
+    }
+    return true;
+}
+
+static std::size_t copy_plain_scalar(const char *in, std::size_t len,
+                                     char *out, bool ascii) {
+    std::size_t n = 0;
+    for (; len - n >= 8; n += 8) {
+        const auto x = load_word(in + n);
+        std::memcpy(out + n, in + n, 8);
+        auto mask = equal_bytes(x, '"') | equal_bytes(x, '\\') |
+                    control_bytes(x);
+        if (ascii)
+            mask |= x & high_bits;
+        if (mask)
+            return n + trailing_zeros(mask) / 8;
+    }
+    for (; n < len; ++n) {
+        const std::uint8_t c = in[n];
+        if (c < 0x20 || c == '"' || c == '\\' || (ascii && c >= 0x80))
+            break;
+        out[n] = in[n];
+    }
+    return n;
+}
+
+static const kernel_table scalar_kernels = {
+    ujson::simd_level::scalar, classify_scalar,
+    validate_utf8_ranges<ascii_length_scalar>, copy_plain_scalar
+};
+
+#ifdef UJSON_USE_SSE2
+static block_bits classify_sse2(const std::uint8_t *ptr) {
+
+    const __m128i tabs = _mm_set1_epi8(0x09);
+    const __m128i newlines = _mm_set1_epi8(0x0A);
+    const __m128i carriage_return = _mm_set1_epi8(0x0D);
+    const __m128i spaces = _mm_set1_epi8(0x20);
+    const __m128i quote = _mm_set1_epi8(0x22);
+    const __m128i backslash = _mm_set1_epi8(0x5C);
+    const __m128i max_control = _mm_set1_epi8(0x1F);
+
+    block_bits bits = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; ++i) {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + 16 * i));
+
+        __m128i is_white_space = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, tabs),
+                         _mm_cmpeq_epi8(chunk, newlines)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return),
+                         _mm_cmpeq_epi8(chunk, spaces)));
+
+        // unsigned chunk <= 0x1F, as there is no unsigned compare
+        __m128i is_control =
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, max_control), max_control);
+        __m128i is_special =
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, backslash), is_control);
+
+        const int shift = 16 * i;
+        bits.whitespace |= static_cast<std::uint64_t>(
+                               static_cast<std::uint16_t>(
+                                   _mm_movemask_epi8(is_white_space)))
+                           << shift;
+        bits.quotes |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+                           _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))))
+                       << shift;
+        bits.special |= static_cast<std::uint64_t>(
+                            static_cast<std::uint16_t>(
+                                _mm_movemask_epi8(is_special)))
+                        << shift;
+        bits.non_ascii |= static_cast<std::uint64_t>(
+                              static_cast<std::uint16_t>(
+                                  _mm_movemask_epi8(chunk)))
+                          << shift;
+    }
+    return bits;
+}
+
+static std::size_t ascii_length_sse2(const char *ptr, std::size_t len) {
+    std::size_t n = 0;
+    for (; len - n >= 16; n += 16) {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + n));
+        // multibyte utf-8 sequences have the high bit set
+        int mask = _mm_movemask_epi8(chunk);
+        if (mask)
+            return n + trailing_zeros(mask);
+    }
+    return n + ascii_length_scalar(ptr + n, len - n);
+}
+
+static std::size_t copy_plain_sse2(const char *in, std::size_t len,
+                                   char *out, bool ascii) {
+    const __m128i quote = _mm_set1_epi8(0x22);
+    const __m128i backslash = _mm_set1_epi8(0x5C);
+    const __m128i spaces = _mm_set1_epi8(0x20);
+    std::size_t n = 0;
+    for (; len - n >= 16; n += 16) {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + n));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n), chunk);
+
+        // signed compare, so bytes >= 0x80 are less than 0x20 as well
+        __m128i escape = _mm_cmplt_epi8(chunk, spaces);
+        if (!ascii)
+            escape = _mm_andnot_si128(
+                _mm_cmplt_epi8(chunk, _mm_setzero_si128()), escape);
+        escape = _mm_or_si128(escape,
+                              _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                           _mm_cmpeq_epi8(chunk, backslash)));
+        int mask = _mm_movemask_epi8(escape);
+        if (mask)
+            return n + trailing_zeros(mask);
+    }
+    return n + copy_plain_scalar(in + n, len - n, out + n, ascii);
+}
+
+static const kernel_table sse2_kernels = {
+    ujson::simd_level::sse2, classify_sse2,
+    validate_utf8_ranges<ascii_length_sse2>, copy_plain_sse2
+};
+#endif
+
+#ifdef UJSON_USE_AVX
+// utf-8 validation by table lookup (Keiser and Lemire, "Validating UTF-8
+// In Less Than One Instruction Per Byte"). The high and low nibble of the
+// previous byte and the high nibble of the current one each look up a set
+// of errors the pair may have; any error present in all three is real.
+// Three and four byte sequences are checked with the bytes two and three
+// back, and a sequence cut off at the end of a chunk carries over.
+namespace utf8_error {
+enum : std::uint8_t {
+    too_short = 1,      // lead byte not followed by a continuation
+    too_long = 2,       // ascii followed by a continuation
+    overlong_3 = 4,     // E0 80..9F
+    too_large = 8,      // F4 90..BF, F5..FF
+    surrogate = 16,     // ED A0..BF
+    overlong_2 = 32,    // C0..C1
+    too_large_1000 = 64,
+    overlong_4 = 64,    // F0 80..8F
+    two_conts = 128,    // continuation following a continuation
+    carry = too_short | too_long | two_conts
+};
+}
+
+static const std::uint8_t utf8_byte_1_high[16] = {
+    utf8_error::too_long, utf8_error::too_long, utf8_error::too_long,
+    utf8_error::too_long, utf8_error::too_long, utf8_error::too_long,
+    utf8_error::too_long, utf8_error::too_long,
+    utf8_error::two_conts, utf8_error::two_conts, utf8_error::two_conts,
+    utf8_error::two_conts,
+    utf8_error::too_short | utf8_error::overlong_2,
+    utf8_error::too_short,
+    utf8_error::too_short | utf8_error::overlong_3 | utf8_error::surrogate,
+    utf8_error::too_short | utf8_error::too_large |
+        utf8_error::too_large_1000 | utf8_error::overlong_4
+};
+
+static const std::uint8_t utf8_byte_1_low[16] = {
+    utf8_error::carry | utf8_error::overlong_3 | utf8_error::overlong_2 |
+        utf8_error::overlong_4,
+    utf8_error::carry | utf8_error::overlong_2,
+    utf8_error::carry,
+    utf8_error::carry,
+    utf8_error::carry | utf8_error::too_large,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000 |
+        utf8_error::surrogate,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000,
+    utf8_error::carry | utf8_error::too_large | utf8_error::too_large_1000
+};
+
+static const std::uint8_t utf8_byte_2_high[16] = {
+    utf8_error::too_short, utf8_error::too_short, utf8_error::too_short,
+    utf8_error::too_short, utf8_error::too_short, utf8_error::too_short,
+    utf8_error::too_short, utf8_error::too_short,
+    utf8_error::too_long | utf8_error::overlong_2 | utf8_error::two_conts |
+        utf8_error::overlong_3 | utf8_error::too_large_1000 |
+        utf8_error::overlong_4,
+    utf8_error::too_long | utf8_error::overlong_2 | utf8_error::two_conts |
+        utf8_error::overlong_3 | utf8_error::too_large,
+    utf8_error::too_long | utf8_error::overlong_2 | utf8_error::two_conts |
+        utf8_error::surrogate | utf8_error::too_large,
+    utf8_error::too_long | utf8_error::overlong_2 | utf8_error::two_conts |
+        utf8_error::surrogate | utf8_error::too_large,
+    utf8_error::too_short, utf8_error::too_short, utf8_error::too_short,
+    utf8_error::too_short
+};
+
+// subtracted from the last bytes of a chunk with saturation; non-zero if a
+// lead byte there needs continuations from the next chunk
+static const std::uint8_t utf8_incomplete[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+};
+
+UJSON_TARGET("ssse3")
+static bool validate_utf8_ssse3(const char *ptr, std::size_t len) {
+    const __m128i byte_1_high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_1_high));
+    const __m128i byte_1_low = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_1_low));
+    const __m128i byte_2_high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_2_high));
+    const __m128i incomplete = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_incomplete + 16));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    char tail[16];
+    for (std::size_t n = 0; n < len; n += 16) {
+        const char *chunk = ptr + n;
+        if (len - n < 16) {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, chunk, len - n);
+            chunk = tail;
+        }
+        const __m128i input =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(chunk));
+
+        if (!_mm_movemask_epi8(input)) {
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_incomplete = _mm_setzero_si128();
+            prev_input = input;
+            continue;
+        }
+
+        const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+        const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+        const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+        const __m128i high1 = _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble);
+        const __m128i low1 = _mm_and_si128(prev1, nibble);
+        const __m128i high2 = _mm_and_si128(_mm_srli_epi16(input, 4), nibble);
+        const __m128i special =
+            _mm_and_si128(_mm_and_si128(_mm_shuffle_epi8(byte_1_high, high1),
+                                        _mm_shuffle_epi8(byte_1_low, low1)),
+                          _mm_shuffle_epi8(byte_2_high, high2));
+
+        // third and fourth bytes must be continuations
+        const __m128i must23 = _mm_and_si128(
+            _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0x60)),
+                         _mm_subs_epu8(prev3, _mm_set1_epi8(0x70))),
+            _mm_set1_epi8(static_cast<char>(0x80)));
+
+        error = _mm_or_si128(error, _mm_xor_si128(must23, special));
+        prev_incomplete = _mm_subs_epu8(input, incomplete);
+        prev_input = input;
+    }
+    error = _mm_or_si128(error, prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) ==
+           0xFFFF;
+}
+
+static const kernel_table ssse3_kernels = {
+    ujson::simd_level::ssse3, classify_sse2, validate_utf8_ssse3,
+    copy_plain_sse2
+};
+
+UJSON_TARGET("avx2")
+static block_bits classify_avx2(const std::uint8_t *ptr) {
+
+    const __m256i tabs = _mm256_set1_epi8(0x09);
+    const __m256i newlines = _mm256_set1_epi8(0x0A);
+    const __m256i carriage_return = _mm256_set1_epi8(0x0D);
+    const __m256i spaces = _mm256_set1_epi8(0x20);
+    const __m256i quote = _mm256_set1_epi8(0x22);
+    const __m256i backslash = _mm256_set1_epi8(0x5C);
+    const __m256i max_control = _mm256_set1_epi8(0x1F);
+
+    block_bits bits = { 0, 0, 0, 0 };
+    for (int i = 0; i < 2; ++i) {
+        __m256i chunk = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(ptr + 32 * i));
+
+        __m256i is_white_space = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, tabs),
+                            _mm256_cmpeq_epi8(chunk, newlines)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriage_return),
+                            _mm256_cmpeq_epi8(chunk, spaces)));
+
+        // unsigned chunk <= 0x1F, as there is no unsigned compare
+        __m256i is_control = _mm256_cmpeq_epi8(
+            _mm256_max_epu8(chunk, max_control), max_control);
+        __m256i is_special =
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, backslash), is_control);
+
+        const int shift = 32 * i;
+        bits.whitespace |= static_cast<std::uint64_t>(
+                               static_cast<std::uint32_t>(
+                                   _mm256_movemask_epi8(is_white_space)))
+                           << shift;
+        bits.quotes |= static_cast<std::uint64_t>(
+                           static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                               _mm256_cmpeq_epi8(chunk, quote))))
+                       << shift;
+        bits.special |= static_cast<std::uint64_t>(
+                            static_cast<std::uint32_t>(
+                                _mm256_movemask_epi8(is_special)))
+                        << shift;
+        bits.non_ascii |= static_cast<std::uint64_t>(
+                              static_cast<std::uint32_t>(
+                                  _mm256_movemask_epi8(chunk)))
+                          << shift;
+    }
+    return bits;
+}
+
+UJSON_TARGET("avx2")
+static std::size_t copy_plain_avx2(const char *in, std::size_t len,
+                                   char *out, bool ascii) {
+    const __m256i quote = _mm256_set1_epi8(0x22);
+    const __m256i backslash = _mm256_set1_epi8(0x5C);
+    const __m256i spaces = _mm256_set1_epi8(0x20);
+    std::size_t n = 0;
+    for (; len - n >= 32; n += 32) {
+        __m256i chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + n));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + n), chunk);
+
+        // signed compare, so bytes >= 0x80 are less than 0x20 as well
+        __m256i escape = _mm256_cmpgt_epi8(spaces, chunk);
+        if (!ascii)
+            escape = _mm256_andnot_si256(
+                _mm256_cmpgt_epi8(_mm256_setzero_si256(), chunk), escape);
+        escape = _mm256_or_si256(
+            escape, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                    _mm256_cmpeq_epi8(chunk, backslash)));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(escape));
+        if (mask)
+            return n + trailing_zeros(mask);
+    }
+    return n + copy_plain_sse2(in + n, len - n, out + n, ascii);
+}
+
+// as validate_utf8_ssse3; the bytes before each lane come from the lane
+// below, or from the previous chunk for the low lane
+UJSON_TARGET("avx2")
+static bool validate_utf8_avx2(const char *ptr, std::size_t len) {
+    const __m256i byte_1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_1_high)));
+    const __m256i byte_1_low = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_1_low)));
+    const __m256i byte_2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(utf8_byte_2_high)));
+    const __m256i incomplete = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(utf8_incomplete));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    char tail[32];
+    for (std::size_t n = 0; n < len; n += 32) {
+        const char *chunk = ptr + n;
+        if (len - n < 32) {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, chunk, len - n);
+            chunk = tail;
+        }
+        const __m256i input =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chunk));
+
+        if (!_mm256_movemask_epi8(input)) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+            prev_input = input;
+            continue;
+        }
+
+        const __m256i before =
+            _mm256_permute2x128_si256(prev_input, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, before, 15);
+        const __m256i prev2 = _mm256_alignr_epi8(input, before, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(input, before, 13);
+
+        const __m256i high1 =
+            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble);
+        const __m256i low1 = _mm256_and_si256(prev1, nibble);
+        const __m256i high2 =
+            _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble);
+        const __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(byte_1_high, high1),
+                             _mm256_shuffle_epi8(byte_1_low, low1)),
+            _mm256_shuffle_epi8(byte_2_high, high2));
+
+        // third and fourth bytes must be continuations
+        const __m256i must23 = _mm256_and_si256(
+            _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0x60)),
+                            _mm256_subs_epu8(prev3, _mm256_set1_epi8(0x70))),
+            _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        error = _mm256_or_si256(error, _mm256_xor_si256(must23, special));
+        prev_incomplete = _mm256_subs_epu8(input, incomplete);
+        prev_input = input;
+    }
+    error = _mm256_or_si256(error, prev_incomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+static const kernel_table avx2_kernels = {
+    ujson::simd_level::avx2, classify_avx2, validate_utf8_avx2,
+    copy_plain_avx2
+};
+
+// the avx-512 kernels handle the tail with masked loads and stores, which
+// never touch memory outside the mask
+
+// mask selecting the first min(len, 64) bytes
+static __mmask64 first_bytes(std::size_t len) {
+    return len >= 64 ? ~__mmask64(0) : (__mmask64(1) << len) - 1;
+}
+
+UJSON_TARGET("avx512bw")
+static block_bits classify_avx512(const std::uint8_t *ptr) {
+    const __m512i chunk = _mm512_loadu_si512(ptr);
+    block_bits bits;
+    bits.whitespace =
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x09)) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x0A)) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x0D)) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x20));
+    bits.quotes = _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x22));
+    bits.special = _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(0x5C)) |
+                   _mm512_cmplt_epu8_mask(chunk, _mm512_set1_epi8(0x20));
+    bits.non_ascii = _mm512_movepi8_mask(chunk);
+    return bits;
+}
+
+UJSON_TARGET("avx512bw")
+static std::size_t copy_plain_avx512(const char *in, std::size_t len,
+                                     char *out, bool ascii) {
+    const __m512i quote = _mm512_set1_epi8(0x22);
+    const __m512i backslash = _mm512_set1_epi8(0x5C);
+    const __m512i spaces = _mm512_set1_epi8(0x20);
+    for (std::size_t n = 0; n < len; n += 64) {
+        const __mmask64 valid = first_bytes(len - n);
+        __m512i chunk = _mm512_maskz_loadu_epi8(valid, in + n);
+        _mm512_mask_storeu_epi8(out + n, valid, chunk);
+        __mmask64 escape = ascii ? _mm512_cmplt_epi8_mask(chunk, spaces)
+                                 : _mm512_cmplt_epu8_mask(chunk, spaces);
+        escape |= _mm512_cmpeq_epi8_mask(chunk, quote) |
+                  _mm512_cmpeq_epi8_mask(chunk, backslash);
+        escape &= valid;
+        if (escape)
+            return n + trailing_zeros(escape);
+    }
+    return len;
+}
+
+static const kernel_table avx512_kernels = {
+    ujson::simd_level::avx512, classify_avx512, validate_utf8_avx2,
+    copy_plain_avx512
+};
+#endif
+
+#ifdef UJSON_USE_SSE2
+static const kernel_table *kernels = &sse2_kernels;
+#else
+static const kernel_table *kernels = &scalar_kernels;
+#endif
+
+ujson::simd_level ujson::detect_simd_level() {
+#if defined UJSON_USE_AVX && defined __GNUC__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+        return simd_level::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return simd_level::avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return simd_level::ssse3;
+#elif defined UJSON_USE_AVX
+    // check both cpu support and that the os saves the registers
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    if (osxsave && max_leaf >= 7) {
+        const auto xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        const bool avx2 = (info[1] & (1 << 5)) != 0;
+        const bool avx512bw =
+            (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+        if (avx512bw && (xcr0 & 0xE6) == 0xE6)
+            return simd_level::avx512;
+        if (avx2 && (xcr0 & 0x06) == 0x06)
+            return simd_level::avx2;
+    }
+    if (ssse3)
+        return simd_level::ssse3;
+#endif
+#ifdef UJSON_USE_SSE2
+    return simd_level::sse2;
+#else
+    return simd_level::scalar;
+#endif
+}
+
+ujson::simd_level ujson::get_simd_level() { return kernels->level; }
+
+void ujson::set_simd_level(simd_level level) {
+    switch (std::min(level, detect_simd_level())) {
+#ifdef UJSON_USE_AVX
+    case simd_level::avx512:
+        kernels = &avx512_kernels;
+        break;
+    case simd_level::avx2:
+        kernels = &avx2_kernels;
+        break;
+    case simd_level::ssse3:
+        kernels = &ssse3_kernels;
+        break;
+#endif
+#ifdef UJSON_USE_SSE2
+    case simd_level::sse2:
+        kernels = &sse2_kernels;
+        break;
+#endif
+    default:
+        kernels = &scalar_kernels;
+        break;
+    }
+}
+
+// select the best kernels at startup
+static struct kernel_selector {
+    kernel_selector() { ujson::set_simd_level(ujson::detect_simd_level()); }
+} select_kernels;
+
 // --------------------------------------------------------------------------
 // utf-8
 //
@@ -93,50 +817,29 @@ static const utf8_ranges_t utf8_ranges[] = {
 static const std::size_t num_utf8_ranges =
     sizeof(utf8_ranges) / sizeof(utf8_ranges[0]);
 
-bool ujson::value::is_valid_utf8(const char *ptr,
-                                 const char *end) noexcept {
-    while (ptr < end) {
-#ifdef UJSON_USE_SSE2
-        // test if the next 16 chars are ascii and skip forward as much as
-        // possible
-        while (end - ptr >= 16) {
-            __m128i chunk =
-                _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
-            // signed comparison: multibyte utf-8 sequences have high bit set
-            // are thus negative
-            __m128i compare = _mm_cmplt_epi8(chunk, _mm_setzero_si128());
-            int mask = _mm_movemask_epi8(compare);
-            if (mask == 0) {
-                ptr += 16;
-                continue;
-            }
+// length of the utf-8 sequence at ptr; zero if it is invalid or cut short
+// by end
+static std::size_t utf8_length(const std::uint8_t *ptr,
+                               const std::uint8_t *end) {
+    auto it = utf8_ranges;
+    while (*ptr > it->upper_bound)
+        ++it;
+    assert(it < utf8_ranges + num_utf8_ranges);
 
-#ifdef __GNUC__
-            int index = __builtin_ffs(mask) - 1;
-#else
-            unsigned long index = 0;
-            _BitScanForward(&index, mask);
-#endif
-            assert(index >= 0 && index <= 15);
-            ptr += index;
-            break;
-        }
-#endif
-        auto c = static_cast<std::uint8_t>(*ptr++);
-        auto it = utf8_ranges;
-        for (; it != utf8_ranges + num_utf8_ranges; ++it) {
-            if (c <= it->upper_bound)
-                break;
-        }
-        assert(it < utf8_ranges + num_utf8_ranges);
-        const auto limit = it->ranges + it->num_ranges;
-        for (auto rng = it->ranges; rng < limit; ++rng) {
-            auto d = static_cast<std::uint8_t>(*ptr++);
-            if (d < rng->first || d >= rng->second)
-                return false;
-        }
+    const std::size_t length = 1 + it->num_ranges;
+    if (static_cast<std::size_t>(end - ptr) < length)
+        return 0;
+    for (std::size_t i = 1; i < length; ++i) {
+        const auto &rng = it->ranges[i - 1];
+        if (ptr[i] < rng.first || ptr[i] >= rng.second)
+            return 0;
     }
-    return true;
+    return length;
+}
+
+bool ujson::value::is_valid_utf8(const char *ptr,
+                                 const char *end) noexcept {
+    return kernels->validate_utf8(ptr, end - ptr);
 }
 
 // convert utf8 to utf32; returns utf32 + number of bytes consumed
@@ -280,9 +983,19 @@ static void to_string(std::string &result, ujson::string_view input,
     const auto old_size = result.size();
     result.resize(old_size + max_size_increase);
 
+    const bool ascii = opts.encoding != ujson::character_encoding::utf8;
+    const auto end = input.c_str() + input.length();
+
     char *out = &result[old_size];
     *out++ = '"';
-    for (auto in = input.c_str(); in != input.c_str() + input.length(); ++in) {
+    for (auto in = input.c_str(); in != end; ++in) {
+
+        // copy as much as possible as is
+        const auto n = kernels->copy_plain(in, end - in, out, ascii);
+        in += n;
+        out += n;
+        if (in == end)
+            break;
 
         std::uint8_t c = *in;
         if (c >= 0x20) {
@@ -371,6 +1084,18 @@ static void to_string(std::string &str, double v) {
     str += builder.Finalize();
 }
 
+static void to_string(std::string &str, std::uint64_t v, bool negative) {
+    char buffer[24];
+    auto ptr = buffer + sizeof(buffer);
+    do {
+        *--ptr = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (negative)
+        *--ptr = '-';
+    str.append(ptr, buffer + sizeof(buffer));
+}
+
 static void to_string_impl(std::string &str, ujson::value const &v,
                            const ujson::to_string_options &opts,
                            std::size_t current_indent) {
@@ -382,7 +1107,19 @@ static void to_string_impl(std::string &str, ujson::value const &v,
         str += bool_cast(v) ? "true" : "false";
         break;
     case ujson::value_type::number:
-        to_string(str, double_cast(v));
+        if (v.is_raw_number()) {
+            auto text = raw_number_cast(v);
+            str.append(text.data(), text.length());
+        } else if (v.is_int64()) {
+            // negate as unsigned, as -min() does not fit
+            const auto i = int64_cast(v);
+            const auto u = static_cast<std::uint64_t>(i);
+            to_string(str, i < 0 ? 0 - u : u, i < 0);
+        } else if (v.is_uint64()) {
+            to_string(str, uint64_cast(v), false);
+        } else {
+            to_string(str, double_cast(v));
+        }
         break;
     case ujson::value_type::string:
         to_string(str, string_cast(v), opts);
@@ -459,32 +1196,35 @@ ujson::exception::exception(error_code error, int line)
 
 const char *ujson::exception::what() const noexcept{
     if (m_what.empty()) {
-        std::stringstream ss;
         switch (m_error_code) {
         case error_code::bad_cast:
-            ss << "Bad cast.";
+            m_what = "Bad cast.";
             break;
         case error_code::bad_number:
             if (m_line == -1)
-                ss << "Bad number.";
+                m_what = "Bad number.";
             else
-                ss << "Bad number on line " << m_line << ".";
+                m_what = "Bad number on line " + std::to_string(m_line) + ".";
             break;
         case error_code::bad_string:
-            ss << "Bad UTF-8.";
+            m_what = "Bad UTF-8.";
             break;
         case error_code::invalid_syntax:
-            ss << "Invalid syntax on line " << m_line << ".";
+            m_what = "Invalid syntax on line " + std::to_string(m_line) + ".";
             break;
         case error_code::integer_overflow:
-            ss << "Number out of range for integer cast.";
+            m_what = "Number out of range for integer cast.";
+            break;
+        case error_code::io_error:
+            m_what = "Error reading input.";
+            break;
+        case error_code::too_deep:
+            m_what = "Nesting too deep on line " + std::to_string(m_line) + ".";
             break;
         default:
             assert(false);
             break;
         }
-
-        m_what = ss.str();
     }
 
     return m_what.c_str();
@@ -497,117 +1237,109 @@ ujson::error_code ujson::exception::get_error_code() const {
 int ujson::exception::get_line() const { return m_line; }
 
 //----------------------------------------------------------------------------
-// parser
-
-namespace {
-
-enum token {
-    ujson_colon,
-    ujson_comma,
-    ujson_null,
-    ujson_true,
-    ujson_false,
-    ujson_number,
-    ujson_string,
-    ujson_array_begin,
-    ujson_array_end,
-    ujson_object_begin,
-    ujson_object_end,
-    ujson_eof
-};
-
-// helper class used for providing a sentinel token to the parser
-// when it reads beyond the supplied buffer
-class safe_ptr {
-public:
-    safe_ptr(const std::uint8_t *ptr, const std::uint8_t *limit);
-
-    inline const std::uint8_t *ptr() const;
-    inline const std::uint8_t *limit() const;
-
-    inline std::uint8_t operator*() const;
-    inline operator const std::uint8_t *() const;
-
-    inline safe_ptr &operator++();
-    inline safe_ptr &operator+=(std::size_t);
-
-    inline safe_ptr &operator=(const std::uint8_t *);
-
-private:
-    const std::uint8_t *m_ptr;
-    const std::uint8_t *m_limit;
-};
-
-class parser {
-public:
-    parser(const std::uint8_t *ptr, std::size_t len);
-
-    token peek_token();
-    token read_token();
-
-    void expect(token token);
-
-    double read_double() const;
-    std::string read_string() const;
-
-    int line() const;
-
-private:
-    token scan();
+// reader
 
-    const std::uint8_t *const m_start;
-    const std::uint8_t *const m_limit;
+using ujson::token;
 
-    bool m_peeked;
-    token m_current_token;
-
-    safe_ptr m_cursor;
-    const std::uint8_t *m_token;
-};
-}
-
-//----------------------------------------------------------------------------
-
-safe_ptr::safe_ptr(const std::uint8_t *ptr, const std::uint8_t *limit)
+ujson::reader::safe_ptr::safe_ptr(const std::uint8_t *ptr,
+                                  const std::uint8_t *limit)
     : m_ptr(ptr), m_limit(limit) {
     assert(m_ptr <= m_limit);
 }
 
-const std::uint8_t *safe_ptr::ptr() const { return m_ptr; }
-const std::uint8_t *safe_ptr::limit() const { return m_limit; }
+const std::uint8_t *ujson::reader::safe_ptr::ptr() const { return m_ptr; }
+
+const std::uint8_t *ujson::reader::safe_ptr::limit() const {
+    return m_limit;
+}
 
-std::uint8_t safe_ptr::operator*() const {
+std::uint8_t ujson::reader::safe_ptr::operator*() const {
     return m_ptr < m_limit ? *m_ptr : 0;
 }
-safe_ptr::operator const std::uint8_t *() const { return m_ptr; }
 
-safe_ptr &safe_ptr::operator++() {
+ujson::reader::safe_ptr::operator const std::uint8_t *() const {
+    return m_ptr;
+}
+
+ujson::reader::safe_ptr &ujson::reader::safe_ptr::operator++() {
     ++m_ptr;
     return *this;
 }
 
-safe_ptr &safe_ptr::operator+=(std::size_t offset) {
+ujson::reader::safe_ptr &
+ujson::reader::safe_ptr::operator+=(std::size_t offset) {
     m_ptr += offset;
     return *this;
 }
 
-safe_ptr &safe_ptr::operator=(const std::uint8_t *ptr) {
+ujson::reader::safe_ptr &
+ujson::reader::safe_ptr::operator=(const std::uint8_t *ptr) {
     m_ptr = ptr;
     return *this;
 }
 
 //----------------------------------------------------------------------------
 
-parser::parser(const std::uint8_t *ptr, std::size_t len)
-    : m_start(ptr), m_limit(ptr + len), m_cursor(ptr, ptr + len) {
+ujson::reader::reader(const char *buffer, std::size_t len, padded p)
+    : m_start(reinterpret_cast<const std::uint8_t *>(buffer)),
+      m_limit(m_start + (len ? len : std::strlen(buffer))),
+      m_padded(p == padded::yes), m_cursor(m_start) {
+    assert(!m_padded || *m_limit == 0);
     m_peeked = false;
+    m_escaped = false;
+    m_insitu_lines = 0;
+    m_record_errors = false;
+    m_failed = false;
+    m_significand = 0;
+    m_exponent = 0;
+    m_negative = false;
+    m_many_digits = false;
+    m_integer = false;
+    classify(m_start);
+}
+
+ujson::reader::reader(const padded_buffer &buffer)
+    : reader(buffer.data(), buffer.size(), padded::yes) {}
+
+int ujson::reader::line() const {
+    return static_cast<int>(std::count(m_start, m_cursor, '\n') -
+                            m_insitu_lines + 1);
+}
+
+std::size_t ujson::reader::token_offset() const {
+    return static_cast<std::size_t>(std::min(m_token, m_limit) - m_start);
+}
+
+std::size_t ujson::reader::offset() const {
+    return static_cast<std::size_t>(std::min(m_cursor, m_limit) - m_start);
+}
+
+void ujson::reader::record_errors() { m_record_errors = true; }
+
+bool ujson::reader::failed() const { return m_failed; }
+
+ujson::error_code ujson::reader::error() const { return m_error; }
+
+std::size_t ujson::reader::error_offset() const { return m_error_offset; }
+
+void ujson::reader::fail(error_code code) const {
+    if (!m_record_errors)
+        throw ujson::exception(code, line());
+    if (!m_failed) {
+        m_failed = true;
+        m_error = code;
+        m_error_offset = token_offset();
+    }
 }
 
-int parser::line() const {
-    return static_cast<int>(std::count(m_start, m_cursor.ptr(), '\n') + 1);
+// fail on a lexical error; if errors are recorded, skip to the end
+token ujson::reader::scan_error() {
+    fail(ujson::error_code::invalid_syntax);
+    m_cursor = m_limit;
+    return token::eof;
 }
 
-token parser::peek_token() {
+token ujson::reader::peek_token() {
     if (!m_peeked) {
         m_current_token = scan();
         m_peeked = true;
@@ -616,7 +1348,7 @@ token parser::peek_token() {
     return m_current_token;
 }
 
-token parser::read_token() {
+token ujson::reader::read_token() {
     if (!m_peeked)
         m_current_token = scan();
 
@@ -624,194 +1356,1381 @@ token parser::read_token() {
     return m_current_token;
 }
 
-void parser::expect(token token) {
-    if (token != read_token())
-        throw ujson::exception(ujson::error_code::invalid_syntax, line());
+void ujson::reader::expect(token t) {
+    if (t != read_token()) {
+        fail(ujson::error_code::invalid_syntax);
+        m_cursor = m_limit;
+        m_peeked = false;
+    }
 }
 
-double parser::read_double() const {
+// --------------------------------------------------------------------------
+// number conversion
+//
+// The scanner collects the decimal significand and exponent of each number.
+// Significands of up to 19 digits are converted with Clinger's fast path
+// when both the significand and the power of ten are exact doubles, and
+// otherwise with the Eisel-Lemire algorithm (Lemire, "Number Parsing at a
+// Gigabyte per Second"), which multiplies by a 128 bit approximation of the
+// power of five. Longer significands and the few cases Eisel-Lemire cannot
+// round are left to double-conversion.
 
-    const auto len = static_cast<int>(m_cursor.ptr() - m_token);
+static const int smallest_power_of_ten = -342;
+static const int largest_power_of_ten = 308;
 
-    using namespace double_conversion;
-    auto flags = StringToDoubleConverter::NO_FLAGS;
-    StringToDoubleConverter s2dc(flags, 0.0, 0.0, nullptr, nullptr);
-    int processed_chars;
-    auto token = reinterpret_cast<const char *>(m_token);
-    double result = s2dc.StringToDouble(token, len, &processed_chars);
+// 5^q for q in [-342, 308], normalized to 128 bits with the high bit set
+// and truncated, or rounded up for negative q
+static const std::uint64_t power_of_five_128[][2] = {
+    { 0xEEF453D6923BD65A, 0x113FAA2906A13B3F },
+    { 0x9558B4661B6565F8, 0x4AC7CA59A424C507 },
+    { 0xBAAEE17FA23EBF76, 0x5D79BCF00D2DF649 },
+    { 0xE95A99DF8ACE6F53, 0xF4D82C2C107973DC },
+    { 0x91D8A02BB6C10594, 0x79071B9B8A4BE869 },
+    { 0xB64EC836A47146F9, 0x9748E2826CDEE284 },
+    { 0xE3E27A444D8D98B7, 0xFD1B1B2308169B25 },
+    { 0x8E6D8C6AB0787F72, 0xFE30F0F5E50E20F7 },
+    { 0xB208EF855C969F4F, 0xBDBD2D335E51A935 },
+    { 0xDE8B2B66B3BC4723, 0xAD2C788035E61382 },
+    { 0x8B16FB203055AC76, 0x4C3BCB5021AFCC31 },
+    { 0xADDCB9E83C6B1793, 0xDF4ABE242A1BBF3D },
+    { 0xD953E8624B85DD78, 0xD71D6DAD34A2AF0D },
+    { 0x87D4713D6F33AA6B, 0x8672648C40E5AD68 },
+    { 0xA9C98D8CCB009506, 0x680EFDAF511F18C2 },
+    { 0xD43BF0EFFDC0BA48, 0x0212BD1B2566DEF2 },
+    { 0x84A57695FE98746D, 0x014BB630F7604B57 },
+    { 0xA5CED43B7E3E9188, 0x419EA3BD35385E2D },
+    { 0xCF42894A5DCE35EA, 0x52064CAC828675B9 },
+    { 0x818995CE7AA0E1B2, 0x7343EFEBD1940993 },
+    { 0xA1EBFB4219491A1F, 0x1014EBE6C5F90BF8 },
+    { 0xCA66FA129F9B60A6, 0xD41A26E077774EF6 },
+    { 0xFD00B897478238D0, 0x8920B098955522B4 },
+    { 0x9E20735E8CB16382, 0x55B46E5F5D5535B0 },
+    { 0xC5A890362FDDBC62, 0xEB2189F734AA831D },
+    { 0xF712B443BBD52B7B, 0xA5E9EC7501D523E4 },
+    { 0x9A6BB0AA55653B2D, 0x47B233C92125366E },
+    { 0xC1069CD4EABE89F8, 0x999EC0BB696E840A },
+    { 0xF148440A256E2C76, 0xC00670EA43CA250D },
+    { 0x96CD2A865764DBCA, 0x380406926A5E5728 },
+    { 0xBC807527ED3E12BC, 0xC605083704F5ECF2 },
+    { 0xEBA09271E88D976B, 0xF7864A44C633682E },
+    { 0x93445B8731587EA3, 0x7AB3EE6AFBE0211D },
+    { 0xB8157268FDAE9E4C, 0x5960EA05BAD82964 },
+    { 0xE61ACF033D1A45DF, 0x6FB92487298E33BD },
+    { 0x8FD0C16206306BAB, 0xA5D3B6D479F8E056 },
+    { 0xB3C4F1BA87BC8696, 0x8F48A4899877186C },
+    { 0xE0B62E2929ABA83C, 0x331ACDABFE94DE87 },
+    { 0x8C71DCD9BA0B4925, 0x9FF0C08B7F1D0B14 },
+    { 0xAF8E5410288E1B6F, 0x07ECF0AE5EE44DD9 },
+    { 0xDB71E91432B1A24A, 0xC9E82CD9F69D6150 },
+    { 0x892731AC9FAF056E, 0xBE311C083A225CD2 },
+    { 0xAB70FE17C79AC6CA, 0x6DBD630A48AAF406 },
+    { 0xD64D3D9DB981787D, 0x092CBBCCDAD5B108 },
+    { 0x85F0468293F0EB4E, 0x25BBF56008C58EA5 },
+    { 0xA76C582338ED2621, 0xAF2AF2B80AF6F24E },
+    { 0xD1476E2C07286FAA, 0x1AF5AF660DB4AEE1 },
+    { 0x82CCA4DB847945CA, 0x50D98D9FC890ED4D },
+    { 0xA37FCE126597973C, 0xE50FF107BAB528A0 },
+    { 0xCC5FC196FEFD7D0C, 0x1E53ED49A96272C8 },
+    { 0xFF77B1FCBEBCDC4F, 0x25E8E89C13BB0F7A },
+    { 0x9FAACF3DF73609B1, 0x77B191618C54E9AC },
+    { 0xC795830D75038C1D, 0xD59DF5B9EF6A2417 },
+    { 0xF97AE3D0D2446F25, 0x4B0573286B44AD1D },
+    { 0x9BECCE62836AC577, 0x4EE367F9430AEC32 },
+    { 0xC2E801FB244576D5, 0x229C41F793CDA73F },
+    { 0xF3A20279ED56D48A, 0x6B43527578C1110F },
+    { 0x9845418C345644D6, 0x830A13896B78AAA9 },
+    { 0xBE5691EF416BD60C, 0x23CC986BC656D553 },
+    { 0xEDEC366B11C6CB8F, 0x2CBFBE86B7EC8AA8 },
+    { 0x94B3A202EB1C3F39, 0x7BF7D71432F3D6A9 },
+    { 0xB9E08A83A5E34F07, 0xDAF5CCD93FB0CC53 },
+    { 0xE858AD248F5C22C9, 0xD1B3400F8F9CFF68 },
+    { 0x91376C36D99995BE, 0x23100809B9C21FA1 },
+    { 0xB58547448FFFFB2D, 0xABD40A0C2832A78A },
+    { 0xE2E69915B3FFF9F9, 0x16C90C8F323F516C },
+    { 0x8DD01FAD907FFC3B, 0xAE3DA7D97F6792E3 },
+    { 0xB1442798F49FFB4A, 0x99CD11CFDF41779C },
+    { 0xDD95317F31C7FA1D, 0x40405643D711D583 },
+    { 0x8A7D3EEF7F1CFC52, 0x482835EA666B2572 },
+    { 0xAD1C8EAB5EE43B66, 0xDA3243650005EECF },
+    { 0xD863B256369D4A40, 0x90BED43E40076A82 },
+    { 0x873E4F75E2224E68, 0x5A7744A6E804A291 },
+    { 0xA90DE3535AAAE202, 0x711515D0A205CB36 },
+    { 0xD3515C2831559A83, 0x0D5A5B44CA873E03 },
+    { 0x8412D9991ED58091, 0xE858790AFE9486C2 },
+    { 0xA5178FFF668AE0B6, 0x626E974DBE39A872 },
+    { 0xCE5D73FF402D98E3, 0xFB0A3D212DC8128F },
+    { 0x80FA687F881C7F8E, 0x7CE66634BC9D0B99 },
+    { 0xA139029F6A239F72, 0x1C1FFFC1EBC44E80 },
+    { 0xC987434744AC874E, 0xA327FFB266B56220 },
+    { 0xFBE9141915D7A922, 0x4BF1FF9F0062BAA8 },
+    { 0x9D71AC8FADA6C9B5, 0x6F773FC3603DB4A9 },
+    { 0xC4CE17B399107C22, 0xCB550FB4384D21D3 },
+    { 0xF6019DA07F549B2B, 0x7E2A53A146606A48 },
+    { 0x99C102844F94E0FB, 0x2EDA7444CBFC426D },
+    { 0xC0314325637A1939, 0xFA911155FEFB5308 },
+    { 0xF03D93EEBC589F88, 0x793555AB7EBA27CA },
+    { 0x96267C7535B763B5, 0x4BC1558B2F3458DE },
+    { 0xBBB01B9283253CA2, 0x9EB1AAEDFB016F16 },
+    { 0xEA9C227723EE8BCB, 0x465E15A979C1CADC },
+    { 0x92A1958A7675175F, 0x0BFACD89EC191EC9 },
+    { 0xB749FAED14125D36, 0xCEF980EC671F667B },
+    { 0xE51C79A85916F484, 0x82B7E12780E7401A },
+    { 0x8F31CC0937AE58D2, 0xD1B2ECB8B0908810 },
+    { 0xB2FE3F0B8599EF07, 0x861FA7E6DCB4AA15 },
+    { 0xDFBDCECE67006AC9, 0x67A791E093E1D49A },
+    { 0x8BD6A141006042BD, 0xE0C8BB2C5C6D24E0 },
+    { 0xAECC49914078536D, 0x58FAE9F773886E18 },
+    { 0xDA7F5BF590966848, 0xAF39A475506A899E },
+    { 0x888F99797A5E012D, 0x6D8406C952429603 },
+    { 0xAAB37FD7D8F58178, 0xC8E5087BA6D33B83 },
+    { 0xD5605FCDCF32E1D6, 0xFB1E4A9A90880A64 },
+    { 0x855C3BE0A17FCD26, 0x5CF2EEA09A55067F },
+    { 0xA6B34AD8C9DFC06F, 0xF42FAA48C0EA481E },
+    { 0xD0601D8EFC57B08B, 0xF13B94DAF124DA26 },
+    { 0x823C12795DB6CE57, 0x76C53D08D6B70858 },
+    { 0xA2CB1717B52481ED, 0x54768C4B0C64CA6E },
+    { 0xCB7DDCDDA26DA268, 0xA9942F5DCF7DFD09 },
+    { 0xFE5D54150B090B02, 0xD3F93B35435D7C4C },
+    { 0x9EFA548D26E5A6E1, 0xC47BC5014A1A6DAF },
+    { 0xC6B8E9B0709F109A, 0x359AB6419CA1091B },
+    { 0xF867241C8CC6D4C0, 0xC30163D203C94B62 },
+    { 0x9B407691D7FC44F8, 0x79E0DE63425DCF1D },
+    { 0xC21094364DFB5636, 0x985915FC12F542E4 },
+    { 0xF294B943E17A2BC4, 0x3E6F5B7B17B2939D },
+    { 0x979CF3CA6CEC5B5A, 0xA705992CEECF9C42 },
+    { 0xBD8430BD08277231, 0x50C6FF782A838353 },
+    { 0xECE53CEC4A314EBD, 0xA4F8BF5635246428 },
+    { 0x940F4613AE5ED136, 0x871B7795E136BE99 },
+    { 0xB913179899F68584, 0x28E2557B59846E3F },
+    { 0xE757DD7EC07426E5, 0x331AEADA2FE589CF },
+    { 0x9096EA6F3848984F, 0x3FF0D2C85DEF7621 },
+    { 0xB4BCA50B065ABE63, 0x0FED077A756B53A9 },
+    { 0xE1EBCE4DC7F16DFB, 0xD3E8495912C62894 },
+    { 0x8D3360F09CF6E4BD, 0x64712DD7ABBBD95C },
+    { 0xB080392CC4349DEC, 0xBD8D794D96AACFB3 },
+    { 0xDCA04777F541C567, 0xECF0D7A0FC5583A0 },
+    { 0x89E42CAAF9491B60, 0xF41686C49DB57244 },
+    { 0xAC5D37D5B79B6239, 0x311C2875C522CED5 },
+    { 0xD77485CB25823AC7, 0x7D633293366B828B },
+    { 0x86A8D39EF77164BC, 0xAE5DFF9C02033197 },
+    { 0xA8530886B54DBDEB, 0xD9F57F830283FDFC },
+    { 0xD267CAA862A12D66, 0xD072DF63C324FD7B },
+    { 0x8380DEA93DA4BC60, 0x4247CB9E59F71E6D },
+    { 0xA46116538D0DEB78, 0x52D9BE85F074E608 },
+    { 0xCD795BE870516656, 0x67902E276C921F8B },
+    { 0x806BD9714632DFF6, 0x00BA1CD8A3DB53B6 },
+    { 0xA086CFCD97BF97F3, 0x80E8A40ECCD228A4 },
+    { 0xC8A883C0FDAF7DF0, 0x6122CD128006B2CD },
+    { 0xFAD2A4B13D1B5D6C, 0x796B805720085F81 },
+    { 0x9CC3A6EEC6311A63, 0xCBE3303674053BB0 },
+    { 0xC3F490AA77BD60FC, 0xBEDBFC4411068A9C },
+    { 0xF4F1B4D515ACB93B, 0xEE92FB5515482D44 },
+    { 0x991711052D8BF3C5, 0x751BDD152D4D1C4A },
+    { 0xBF5CD54678EEF0B6, 0xD262D45A78A0635D },
+    { 0xEF340A98172AACE4, 0x86FB897116C87C34 },
+    { 0x9580869F0E7AAC0E, 0xD45D35E6AE3D4DA0 },
+    { 0xBAE0A846D2195712, 0x8974836059CCA109 },
+    { 0xE998D258869FACD7, 0x2BD1A438703FC94B },
+    { 0x91FF83775423CC06, 0x7B6306A34627DDCF },
+    { 0xB67F6455292CBF08, 0x1A3BC84C17B1D542 },
+    { 0xE41F3D6A7377EECA, 0x20CABA5F1D9E4A93 },
+    { 0x8E938662882AF53E, 0x547EB47B7282EE9C },
+    { 0xB23867FB2A35B28D, 0xE99E619A4F23AA43 },
+    { 0xDEC681F9F4C31F31, 0x6405FA00E2EC94D4 },
+    { 0x8B3C113C38F9F37E, 0xDE83BC408DD3DD04 },
+    { 0xAE0B158B4738705E, 0x9624AB50B148D445 },
+    { 0xD98DDAEE19068C76, 0x3BADD624DD9B0957 },
+    { 0x87F8A8D4CFA417C9, 0xE54CA5D70A80E5D6 },
+    { 0xA9F6D30A038D1DBC, 0x5E9FCF4CCD211F4C },
+    { 0xD47487CC8470652B, 0x7647C3200069671F },
+    { 0x84C8D4DFD2C63F3B, 0x29ECD9F40041E073 },
+    { 0xA5FB0A17C777CF09, 0xF468107100525890 },
+    { 0xCF79CC9DB955C2CC, 0x7182148D4066EEB4 },
+    { 0x81AC1FE293D599BF, 0xC6F14CD848405530 },
+    { 0xA21727DB38CB002F, 0xB8ADA00E5A506A7C },
+    { 0xCA9CF1D206FDC03B, 0xA6D90811F0E4851C },
+    { 0xFD442E4688BD304A, 0x908F4A166D1DA663 },
+    { 0x9E4A9CEC15763E2E, 0x9A598E4E043287FE },
+    { 0xC5DD44271AD3CDBA, 0x40EFF1E1853F29FD },
+    { 0xF7549530E188C128, 0xD12BEE59E68EF47C },
+    { 0x9A94DD3E8CF578B9, 0x82BB74F8301958CE },
+    { 0xC13A148E3032D6E7, 0xE36A52363C1FAF01 },
+    { 0xF18899B1BC3F8CA1, 0xDC44E6C3CB279AC1 },
+    { 0x96F5600F15A7B7E5, 0x29AB103A5EF8C0B9 },
+    { 0xBCB2B812DB11A5DE, 0x7415D448F6B6F0E7 },
+    { 0xEBDF661791D60F56, 0x111B495B3464AD21 },
+    { 0x936B9FCEBB25C995, 0xCAB10DD900BEEC34 },
+    { 0xB84687C269EF3BFB, 0x3D5D514F40EEA742 },
+    { 0xE65829B3046B0AFA, 0x0CB4A5A3112A5112 },
+    { 0x8FF71A0FE2C2E6DC, 0x47F0E785EABA72AB },
+    { 0xB3F4E093DB73A093, 0x59ED216765690F56 },
+    { 0xE0F218B8D25088B8, 0x306869C13EC3532C },
+    { 0x8C974F7383725573, 0x1E414218C73A13FB },
+    { 0xAFBD2350644EEACF, 0xE5D1929EF90898FA },
+    { 0xDBAC6C247D62A583, 0xDF45F746B74ABF39 },
+    { 0x894BC396CE5DA772, 0x6B8BBA8C328EB783 },
+    { 0xAB9EB47C81F5114F, 0x066EA92F3F326564 },
+    { 0xD686619BA27255A2, 0xC80A537B0EFEFEBD },
+    { 0x8613FD0145877585, 0xBD06742CE95F5F36 },
+    { 0xA798FC4196E952E7, 0x2C48113823B73704 },
+    { 0xD17F3B51FCA3A7A0, 0xF75A15862CA504C5 },
+    { 0x82EF85133DE648C4, 0x9A984D73DBE722FB },
+    { 0xA3AB66580D5FDAF5, 0xC13E60D0D2E0EBBA },
+    { 0xCC963FEE10B7D1B3, 0x318DF905079926A8 },
+    { 0xFFBBCFE994E5C61F, 0xFDF17746497F7052 },
+    { 0x9FD561F1FD0F9BD3, 0xFEB6EA8BEDEFA633 },
+    { 0xC7CABA6E7C5382C8, 0xFE64A52EE96B8FC0 },
+    { 0xF9BD690A1B68637B, 0x3DFDCE7AA3C673B0 },
+    { 0x9C1661A651213E2D, 0x06BEA10CA65C084E },
+    { 0xC31BFA0FE5698DB8, 0x486E494FCFF30A62 },
+    { 0xF3E2F893DEC3F126, 0x5A89DBA3C3EFCCFA },
+    { 0x986DDB5C6B3A76B7, 0xF89629465A75E01C },
+    { 0xBE89523386091465, 0xF6BBB397F1135823 },
+    { 0xEE2BA6C0678B597F, 0x746AA07DED582E2C },
+    { 0x94DB483840B717EF, 0xA8C2A44EB4571CDC },
+    { 0xBA121A4650E4DDEB, 0x92F34D62616CE413 },
+    { 0xE896A0D7E51E1566, 0x77B020BAF9C81D17 },
+    { 0x915E2486EF32CD60, 0x0ACE1474DC1D122E },
+    { 0xB5B5ADA8AAFF80B8, 0x0D819992132456BA },
+    { 0xE3231912D5BF60E6, 0x10E1FFF697ED6C69 },
+    { 0x8DF5EFABC5979C8F, 0xCA8D3FFA1EF463C1 },
+    { 0xB1736B96B6FD83B3, 0xBD308FF8A6B17CB2 },
+    { 0xDDD0467C64BCE4A0, 0xAC7CB3F6D05DDBDE },
+    { 0x8AA22C0DBEF60EE4, 0x6BCDF07A423AA96B },
+    { 0xAD4AB7112EB3929D, 0x86C16C98D2C953C6 },
+    { 0xD89D64D57A607744, 0xE871C7BF077BA8B7 },
+    { 0x87625F056C7C4A8B, 0x11471CD764AD4972 },
+    { 0xA93AF6C6C79B5D2D, 0xD598E40D3DD89BCF },
+    { 0xD389B47879823479, 0x4AFF1D108D4EC2C3 },
+    { 0x843610CB4BF160CB, 0xCEDF722A585139BA },
+    { 0xA54394FE1EEDB8FE, 0xC2974EB4EE658828 },
+    { 0xCE947A3DA6A9273E, 0x733D226229FEEA32 },
+    { 0x811CCC668829B887, 0x0806357D5A3F525F },
+    { 0xA163FF802A3426A8, 0xCA07C2DCB0CF26F7 },
+    { 0xC9BCFF6034C13052, 0xFC89B393DD02F0B5 },
+    { 0xFC2C3F3841F17C67, 0xBBAC2078D443ACE2 },
+    { 0x9D9BA7832936EDC0, 0xD54B944B84AA4C0D },
+    { 0xC5029163F384A931, 0x0A9E795E65D4DF11 },
+    { 0xF64335BCF065D37D, 0x4D4617B5FF4A16D5 },
+    { 0x99EA0196163FA42E, 0x504BCED1BF8E4E45 },
+    { 0xC06481FB9BCF8D39, 0xE45EC2862F71E1D6 },
+    { 0xF07DA27A82C37088, 0x5D767327BB4E5A4C },
+    { 0x964E858C91BA2655, 0x3A6A07F8D510F86F },
+    { 0xBBE226EFB628AFEA, 0x890489F70A55368B },
+    { 0xEADAB0ABA3B2DBE5, 0x2B45AC74CCEA842E },
+    { 0x92C8AE6B464FC96F, 0x3B0B8BC90012929D },
+    { 0xB77ADA0617E3BBCB, 0x09CE6EBB40173744 },
+    { 0xE55990879DDCAABD, 0xCC420A6A101D0515 },
+    { 0x8F57FA54C2A9EAB6, 0x9FA946824A12232D },
+    { 0xB32DF8E9F3546564, 0x47939822DC96ABF9 },
+    { 0xDFF9772470297EBD, 0x59787E2B93BC56F7 },
+    { 0x8BFBEA76C619EF36, 0x57EB4EDB3C55B65A },
+    { 0xAEFAE51477A06B03, 0xEDE622920B6B23F1 },
+    { 0xDAB99E59958885C4, 0xE95FAB368E45ECED },
+    { 0x88B402F7FD75539B, 0x11DBCB0218EBB414 },
+    { 0xAAE103B5FCD2A881, 0xD652BDC29F26A119 },
+    { 0xD59944A37C0752A2, 0x4BE76D3346F0495F },
+    { 0x857FCAE62D8493A5, 0x6F70A4400C562DDB },
+    { 0xA6DFBD9FB8E5B88E, 0xCB4CCD500F6BB952 },
+    { 0xD097AD07A71F26B2, 0x7E2000A41346A7A7 },
+    { 0x825ECC24C873782F, 0x8ED400668C0C28C8 },
+    { 0xA2F67F2DFA90563B, 0x728900802F0F32FA },
+    { 0xCBB41EF979346BCA, 0x4F2B40A03AD2FFB9 },
+    { 0xFEA126B7D78186BC, 0xE2F610C84987BFA8 },
+    { 0x9F24B832E6B0F436, 0x0DD9CA7D2DF4D7C9 },
+    { 0xC6EDE63FA05D3143, 0x91503D1C79720DBB },
+    { 0xF8A95FCF88747D94, 0x75A44C6397CE912A },
+    { 0x9B69DBE1B548CE7C, 0xC986AFBE3EE11ABA },
+    { 0xC24452DA229B021B, 0xFBE85BADCE996168 },
+    { 0xF2D56790AB41C2A2, 0xFAE27299423FB9C3 },
+    { 0x97C560BA6B0919A5, 0xDCCD879FC967D41A },
+    { 0xBDB6B8E905CB600F, 0x5400E987BBC1C920 },
+    { 0xED246723473E3813, 0x290123E9AAB23B68 },
+    { 0x9436C0760C86E30B, 0xF9A0B6720AAF6521 },
+    { 0xB94470938FA89BCE, 0xF808E40E8D5B3E69 },
+    { 0xE7958CB87392C2C2, 0xB60B1D1230B20E04 },
+    { 0x90BD77F3483BB9B9, 0xB1C6F22B5E6F48C2 },
+    { 0xB4ECD5F01A4AA828, 0x1E38AEB6360B1AF3 },
+    { 0xE2280B6C20DD5232, 0x25C6DA63C38DE1B0 },
+    { 0x8D590723948A535F, 0x579C487E5A38AD0E },
+    { 0xB0AF48EC79ACE837, 0x2D835A9DF0C6D851 },
+    { 0xDCDB1B2798182244, 0xF8E431456CF88E65 },
+    { 0x8A08F0F8BF0F156B, 0x1B8E9ECB641B58FF },
+    { 0xAC8B2D36EED2DAC5, 0xE272467E3D222F3F },
+    { 0xD7ADF884AA879177, 0x5B0ED81DCC6ABB0F },
+    { 0x86CCBB52EA94BAEA, 0x98E947129FC2B4E9 },
+    { 0xA87FEA27A539E9A5, 0x3F2398D747B36224 },
+    { 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD },
+    { 0x83A3EEEEF9153E89, 0x1953CF68300424AC },
+    { 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7 },
+    { 0xCDB02555653131B6, 0x3792F412CB06794D },
+    { 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0 },
+    { 0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4 },
+    { 0xC8DE047564D20A8B, 0xF245825A5A445275 },
+    { 0xFB158592BE068D2E, 0xEED6E2F0F0D56712 },
+    { 0x9CED737BB6C4183D, 0x55464DD69685606B },
+    { 0xC428D05AA4751E4C, 0xAA97E14C3C26B886 },
+    { 0xF53304714D9265DF, 0xD53DD99F4B3066A8 },
+    { 0x993FE2C6D07B7FAB, 0xE546A8038EFE4029 },
+    { 0xBF8FDB78849A5F96, 0xDE98520472BDD033 },
+    { 0xEF73D256A5C0F77C, 0x963E66858F6D4440 },
+    { 0x95A8637627989AAD, 0xDDE7001379A44AA8 },
+    { 0xBB127C53B17EC159, 0x5560C018580D5D52 },
+    { 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6 },
+    { 0x9226712162AB070D, 0xCAB3961304CA70E8 },
+    { 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22 },
+    { 0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A },
+    { 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242 },
+    { 0xB267ED1940F1C61C, 0x55F038B237591ED3 },
+    { 0xDF01E85F912E37A3, 0x6B6C46DEC52F6688 },
+    { 0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015 },
+    { 0xAE397D8AA96C1B77, 0xABEC975E0A0D081A },
+    { 0xD9C7DCED53C72255, 0x96E7BD358C904A21 },
+    { 0x881CEA14545C7575, 0x7E50D64177DA2E54 },
+    { 0xAA242499697392D2, 0xDDE50BD1D5D0B9E9 },
+    { 0xD4AD2DBFC3D07787, 0x955E4EC64B44E864 },
+    { 0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E },
+    { 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E },
+    { 0xCFB11EAD453994BA, 0x67DE18EDA5814AF2 },
+    { 0x81CEB32C4B43FCF4, 0x80EACF948770CED7 },
+    { 0xA2425FF75E14FC31, 0xA1258379A94D028D },
+    { 0xCAD2F7F5359A3B3E, 0x096EE45813A04330 },
+    { 0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC },
+    { 0x9E74D1B791E07E48, 0x775EA264CF55347E },
+    { 0xC612062576589DDA, 0x95364AFE032A819E },
+    { 0xF79687AED3EEC551, 0x3A83DDBD83F52205 },
+    { 0x9ABE14CD44753B52, 0xC4926A9672793543 },
+    { 0xC16D9A0095928A27, 0x75B7053C0F178294 },
+    { 0xF1C90080BAF72CB1, 0x5324C68B12DD6339 },
+    { 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E04 },
+    { 0xBCE5086492111AEA, 0x88F4BB1CA6BCF585 },
+    { 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E6 },
+    { 0x9392EE8E921D5D07, 0x3AFF322E62439FD0 },
+    { 0xB877AA3236A4B449, 0x09BEFEB9FAD487C3 },
+    { 0xE69594BEC44DE15B, 0x4C2EBE687989A9B4 },
+    { 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A11 },
+    { 0xB424DC35095CD80F, 0x538484C19EF38C95 },
+    { 0xE12E13424BB40E13, 0x2865A5F206B06FBA },
+    { 0x8CBCCC096F5088CB, 0xF93F87B7442E45D4 },
+    { 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D749 },
+    { 0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1C },
+    { 0x89705F4136B4A597, 0x31680A88F8953031 },
+    { 0xABCC77118461CEFC, 0xFDC20D2B36BA7C3E },
+    { 0xD6BF94D5E57A42BC, 0x3D32907604691B4D },
+    { 0x8637BD05AF6C69B5, 0xA63F9A49C2C1B110 },
+    { 0xA7C5AC471B478423, 0x0FCF80DC33721D54 },
+    { 0xD1B71758E219652B, 0xD3C36113404EA4A9 },
+    { 0x83126E978D4FDF3B, 0x645A1CAC083126EA },
+    { 0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A4 },
+    { 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCD },
+    { 0x8000000000000000, 0x0000000000000000 },
+    { 0xA000000000000000, 0x0000000000000000 },
+    { 0xC800000000000000, 0x0000000000000000 },
+    { 0xFA00000000000000, 0x0000000000000000 },
+    { 0x9C40000000000000, 0x0000000000000000 },
+    { 0xC350000000000000, 0x0000000000000000 },
+    { 0xF424000000000000, 0x0000000000000000 },
+    { 0x9896800000000000, 0x0000000000000000 },
+    { 0xBEBC200000000000, 0x0000000000000000 },
+    { 0xEE6B280000000000, 0x0000000000000000 },
+    { 0x9502F90000000000, 0x0000000000000000 },
+    { 0xBA43B74000000000, 0x0000000000000000 },
+    { 0xE8D4A51000000000, 0x0000000000000000 },
+    { 0x9184E72A00000000, 0x0000000000000000 },
+    { 0xB5E620F480000000, 0x0000000000000000 },
+    { 0xE35FA931A0000000, 0x0000000000000000 },
+    { 0x8E1BC9BF04000000, 0x0000000000000000 },
+    { 0xB1A2BC2EC5000000, 0x0000000000000000 },
+    { 0xDE0B6B3A76400000, 0x0000000000000000 },
+    { 0x8AC7230489E80000, 0x0000000000000000 },
+    { 0xAD78EBC5AC620000, 0x0000000000000000 },
+    { 0xD8D726B7177A8000, 0x0000000000000000 },
+    { 0x878678326EAC9000, 0x0000000000000000 },
+    { 0xA968163F0A57B400, 0x0000000000000000 },
+    { 0xD3C21BCECCEDA100, 0x0000000000000000 },
+    { 0x84595161401484A0, 0x0000000000000000 },
+    { 0xA56FA5B99019A5C8, 0x0000000000000000 },
+    { 0xCECB8F27F4200F3A, 0x0000000000000000 },
+    { 0x813F3978F8940984, 0x4000000000000000 },
+    { 0xA18F07D736B90BE5, 0x5000000000000000 },
+    { 0xC9F2C9CD04674EDE, 0xA400000000000000 },
+    { 0xFC6F7C4045812296, 0x4D00000000000000 },
+    { 0x9DC5ADA82B70B59D, 0xF020000000000000 },
+    { 0xC5371912364CE305, 0x6C28000000000000 },
+    { 0xF684DF56C3E01BC6, 0xC732000000000000 },
+    { 0x9A130B963A6C115C, 0x3C7F400000000000 },
+    { 0xC097CE7BC90715B3, 0x4B9F100000000000 },
+    { 0xF0BDC21ABB48DB20, 0x1E86D40000000000 },
+    { 0x96769950B50D88F4, 0x1314448000000000 },
+    { 0xBC143FA4E250EB31, 0x17D955A000000000 },
+    { 0xEB194F8E1AE525FD, 0x5DCFAB0800000000 },
+    { 0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000 },
+    { 0xB7ABC627050305AD, 0xF14A3D9E40000000 },
+    { 0xE596B7B0C643C719, 0x6D9CCD05D0000000 },
+    { 0x8F7E32CE7BEA5C6F, 0xE4820023A2000000 },
+    { 0xB35DBF821AE4F38B, 0xDDA2802C8A800000 },
+    { 0xE0352F62A19E306E, 0xD50B2037AD200000 },
+    { 0x8C213D9DA502DE45, 0x4526F422CC340000 },
+    { 0xAF298D050E4395D6, 0x9670B12B7F410000 },
+    { 0xDAF3F04651D47B4C, 0x3C0CDD765F114000 },
+    { 0x88D8762BF324CD0F, 0xA5880A69FB6AC800 },
+    { 0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00 },
+    { 0xD5D238A4ABE98068, 0x72A4904598D6D880 },
+    { 0x85A36366EB71F041, 0x47A6DA2B7F864750 },
+    { 0xA70C3C40A64E6C51, 0x999090B65F67D924 },
+    { 0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D },
+    { 0x82818F1281ED449F, 0xBFF8F10E7A8921A4 },
+    { 0xA321F2D7226895C7, 0xAFF72D52192B6A0D },
+    { 0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490 },
+    { 0xFEE50B7025C36A08, 0x02F236D04753D5B4 },
+    { 0x9F4F2726179A2245, 0x01D762422C946590 },
+    { 0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5 },
+    { 0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2 },
+    { 0x9B934C3B330C8577, 0x63CC55F49F88EB2F },
+    { 0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB },
+    { 0xF316271C7FC3908A, 0x8BEF464E3945EF7A },
+    { 0x97EDD871CFDA3A56, 0x97758BF0E3CBB5AC },
+    { 0xBDE94E8E43D0C8EC, 0x3D52EEED1CBEA317 },
+    { 0xED63A231D4C4FB27, 0x4CA7AAA863EE4BDD },
+    { 0x945E455F24FB1CF8, 0x8FE8CAA93E74EF6A },
+    { 0xB975D6B6EE39E436, 0xB3E2FD538E122B44 },
+    { 0xE7D34C64A9C85D44, 0x60DBBCA87196B616 },
+    { 0x90E40FBEEA1D3A4A, 0xBC8955E946FE31CD },
+    { 0xB51D13AEA4A488DD, 0x6BABAB6398BDBE41 },
+    { 0xE264589A4DCDAB14, 0xC696963C7EED2DD1 },
+    { 0x8D7EB76070A08AEC, 0xFC1E1DE5CF543CA2 },
+    { 0xB0DE65388CC8ADA8, 0x3B25A55F43294BCB },
+    { 0xDD15FE86AFFAD912, 0x49EF0EB713F39EBE },
+    { 0x8A2DBF142DFCC7AB, 0x6E3569326C784337 },
+    { 0xACB92ED9397BF996, 0x49C2C37F07965404 },
+    { 0xD7E77A8F87DAF7FB, 0xDC33745EC97BE906 },
+    { 0x86F0AC99B4E8DAFD, 0x69A028BB3DED71A3 },
+    { 0xA8ACD7C0222311BC, 0xC40832EA0D68CE0C },
+    { 0xD2D80DB02AABD62B, 0xF50A3FA490C30190 },
+    { 0x83C7088E1AAB65DB, 0x792667C6DA79E0FA },
+    { 0xA4B8CAB1A1563F52, 0x577001B891185938 },
+    { 0xCDE6FD5E09ABCF26, 0xED4C0226B55E6F86 },
+    { 0x80B05E5AC60B6178, 0x544F8158315B05B4 },
+    { 0xA0DC75F1778E39D6, 0x696361AE3DB1C721 },
+    { 0xC913936DD571C84C, 0x03BC3A19CD1E38E9 },
+    { 0xFB5878494ACE3A5F, 0x04AB48A04065C723 },
+    { 0x9D174B2DCEC0E47B, 0x62EB0D64283F9C76 },
+    { 0xC45D1DF942711D9A, 0x3BA5D0BD324F8394 },
+    { 0xF5746577930D6500, 0xCA8F44EC7EE36479 },
+    { 0x9968BF6ABBE85F20, 0x7E998B13CF4E1ECB },
+    { 0xBFC2EF456AE276E8, 0x9E3FEDD8C321A67E },
+    { 0xEFB3AB16C59B14A2, 0xC5CFE94EF3EA101E },
+    { 0x95D04AEE3B80ECE5, 0xBBA1F1D158724A12 },
+    { 0xBB445DA9CA61281F, 0x2A8A6E45AE8EDC97 },
+    { 0xEA1575143CF97226, 0xF52D09D71A3293BD },
+    { 0x924D692CA61BE758, 0x593C2626705F9C56 },
+    { 0xB6E0C377CFA2E12E, 0x6F8B2FB00C77836C },
+    { 0xE498F455C38B997A, 0x0B6DFB9C0F956447 },
+    { 0x8EDF98B59A373FEC, 0x4724BD4189BD5EAC },
+    { 0xB2977EE300C50FE7, 0x58EDEC91EC2CB657 },
+    { 0xDF3D5E9BC0F653E1, 0x2F2967B66737E3ED },
+    { 0x8B865B215899F46C, 0xBD79E0D20082EE74 },
+    { 0xAE67F1E9AEC07187, 0xECD8590680A3AA11 },
+    { 0xDA01EE641A708DE9, 0xE80E6F4820CC9495 },
+    { 0x884134FE908658B2, 0x3109058D147FDCDD },
+    { 0xAA51823E34A7EEDE, 0xBD4B46F0599FD415 },
+    { 0xD4E5E2CDC1D1EA96, 0x6C9E18AC7007C91A },
+    { 0x850FADC09923329E, 0x03E2CF6BC604DDB0 },
+    { 0xA6539930BF6BFF45, 0x84DB8346B786151C },
+    { 0xCFE87F7CEF46FF16, 0xE612641865679A63 },
+    { 0x81F14FAE158C5F6E, 0x4FCB7E8F3F60C07E },
+    { 0xA26DA3999AEF7749, 0xE3BE5E330F38F09D },
+    { 0xCB090C8001AB551C, 0x5CADF5BFD3072CC5 },
+    { 0xFDCB4FA002162A63, 0x73D9732FC7C8F7F6 },
+    { 0x9E9F11C4014DDA7E, 0x2867E7FDDCDD9AFA },
+    { 0xC646D63501A1511D, 0xB281E1FD541501B8 },
+    { 0xF7D88BC24209A565, 0x1F225A7CA91A4226 },
+    { 0x9AE757596946075F, 0x3375788DE9B06958 },
+    { 0xC1A12D2FC3978937, 0x0052D6B1641C83AE },
+    { 0xF209787BB47D6B84, 0xC0678C5DBD23A49A },
+    { 0x9745EB4D50CE6332, 0xF840B7BA963646E0 },
+    { 0xBD176620A501FBFF, 0xB650E5A93BC3D898 },
+    { 0xEC5D3FA8CE427AFF, 0xA3E51F138AB4CEBE },
+    { 0x93BA47C980E98CDF, 0xC66F336C36B10137 },
+    { 0xB8A8D9BBE123F017, 0xB80B0047445D4184 },
+    { 0xE6D3102AD96CEC1D, 0xA60DC059157491E5 },
+    { 0x9043EA1AC7E41392, 0x87C89837AD68DB2F },
+    { 0xB454E4A179DD1877, 0x29BABE4598C311FB },
+    { 0xE16A1DC9D8545E94, 0xF4296DD6FEF3D67A },
+    { 0x8CE2529E2734BB1D, 0x1899E4A65F58660C },
+    { 0xB01AE745B101E9E4, 0x5EC05DCFF72E7F8F },
+    { 0xDC21A1171D42645D, 0x76707543F4FA1F73 },
+    { 0x899504AE72497EBA, 0x6A06494A791C53A8 },
+    { 0xABFA45DA0EDBDE69, 0x0487DB9D17636892 },
+    { 0xD6F8D7509292D603, 0x45A9D2845D3C42B6 },
+    { 0x865B86925B9BC5C2, 0x0B8A2392BA45A9B2 },
+    { 0xA7F26836F282B732, 0x8E6CAC7768D7141E },
+    { 0xD1EF0244AF2364FF, 0x3207D795430CD926 },
+    { 0x8335616AED761F1F, 0x7F44E6BD49E807B8 },
+    { 0xA402B9C5A8D3A6E7, 0x5F16206C9C6209A6 },
+    { 0xCD036837130890A1, 0x36DBA887C37A8C0F },
+    { 0x802221226BE55A64, 0xC2494954DA2C9789 },
+    { 0xA02AA96B06DEB0FD, 0xF2DB9BAA10B7BD6C },
+    { 0xC83553C5C8965D3D, 0x6F92829494E5ACC7 },
+    { 0xFA42A8B73ABBF48C, 0xCB772339BA1F17F9 },
+    { 0x9C69A97284B578D7, 0xFF2A760414536EFB },
+    { 0xC38413CF25E2D70D, 0xFEF5138519684ABA },
+    { 0xF46518C2EF5B8CD1, 0x7EB258665FC25D69 },
+    { 0x98BF2F79D5993802, 0xEF2F773FFBD97A61 },
+    { 0xBEEEFB584AFF8603, 0xAAFB550FFACFD8FA },
+    { 0xEEAABA2E5DBF6784, 0x95BA2A53F983CF38 },
+    { 0x952AB45CFA97A0B2, 0xDD945A747BF26183 },
+    { 0xBA756174393D88DF, 0x94F971119AEEF9E4 },
+    { 0xE912B9D1478CEB17, 0x7A37CD5601AAB85D },
+    { 0x91ABB422CCB812EE, 0xAC62E055C10AB33A },
+    { 0xB616A12B7FE617AA, 0x577B986B314D6009 },
+    { 0xE39C49765FDF9D94, 0xED5A7E85FDA0B80B },
+    { 0x8E41ADE9FBEBC27D, 0x14588F13BE847307 },
+    { 0xB1D219647AE6B31C, 0x596EB2D8AE258FC8 },
+    { 0xDE469FBD99A05FE3, 0x6FCA5F8ED9AEF3BB },
+    { 0x8AEC23D680043BEE, 0x25DE7BB9480D5854 },
+    { 0xADA72CCC20054AE9, 0xAF561AA79A10AE6A },
+    { 0xD910F7FF28069DA4, 0x1B2BA1518094DA04 },
+    { 0x87AA9AFF79042286, 0x90FB44D2F05D0842 },
+    { 0xA99541BF57452B28, 0x353A1607AC744A53 },
+    { 0xD3FA922F2D1675F2, 0x42889B8997915CE8 },
+    { 0x847C9B5D7C2E09B7, 0x69956135FEBADA11 },
+    { 0xA59BC234DB398C25, 0x43FAB9837E699095 },
+    { 0xCF02B2C21207EF2E, 0x94F967E45E03F4BB },
+    { 0x8161AFB94B44F57D, 0x1D1BE0EEBAC278F5 },
+    { 0xA1BA1BA79E1632DC, 0x6462D92A69731732 },
+    { 0xCA28A291859BBF93, 0x7D7B8F7503CFDCFE },
+    { 0xFCB2CB35E702AF78, 0x5CDA735244C3D43E },
+    { 0x9DEFBF01B061ADAB, 0x3A0888136AFA64A7 },
+    { 0xC56BAEC21C7A1916, 0x088AAA1845B8FDD0 },
+    { 0xF6C69A72A3989F5B, 0x8AAD549E57273D45 },
+    { 0x9A3C2087A63F6399, 0x36AC54E2F678864B },
+    { 0xC0CB28A98FCF3C7F, 0x84576A1BB416A7DD },
+    { 0xF0FDF2D3F3C30B9F, 0x656D44A2A11C51D5 },
+    { 0x969EB7C47859E743, 0x9F644AE5A4B1B325 },
+    { 0xBC4665B596706114, 0x873D5D9F0DDE1FEE },
+    { 0xEB57FF22FC0C7959, 0xA90CB506D155A7EA },
+    { 0x9316FF75DD87CBD8, 0x09A7F12442D588F2 },
+    { 0xB7DCBF5354E9BECE, 0x0C11ED6D538AEB2F },
+    { 0xE5D3EF282A242E81, 0x8F1668C8A86DA5FA },
+    { 0x8FA475791A569D10, 0xF96E017D694487BC },
+    { 0xB38D92D760EC4455, 0x37C981DCC395A9AC },
+    { 0xE070F78D3927556A, 0x85BBE253F47B1417 },
+    { 0x8C469AB843B89562, 0x93956D7478CCEC8E },
+    { 0xAF58416654A6BABB, 0x387AC8D1970027B2 },
+    { 0xDB2E51BFE9D0696A, 0x06997B05FCC0319E },
+    { 0x88FCF317F22241E2, 0x441FECE3BDF81F03 },
+    { 0xAB3C2FDDEEAAD25A, 0xD527E81CAD7626C3 },
+    { 0xD60B3BD56A5586F1, 0x8A71E223D8D3B074 },
+    { 0x85C7056562757456, 0xF6872D5667844E49 },
+    { 0xA738C6BEBB12D16C, 0xB428F8AC016561DB },
+    { 0xD106F86E69D785C7, 0xE13336D701BEBA52 },
+    { 0x82A45B450226B39C, 0xECC0024661173473 },
+    { 0xA34D721642B06084, 0x27F002D7F95D0190 },
+    { 0xCC20CE9BD35C78A5, 0x31EC038DF7B441F4 },
+    { 0xFF290242C83396CE, 0x7E67047175A15271 },
+    { 0x9F79A169BD203E41, 0x0F0062C6E984D386 },
+    { 0xC75809C42C684DD1, 0x52C07B78A3E60868 },
+    { 0xF92E0C3537826145, 0xA7709A56CCDF8A82 },
+    { 0x9BBCC7A142B17CCB, 0x88A66076400BB691 },
+    { 0xC2ABF989935DDBFE, 0x6ACFF893D00EA435 },
+    { 0xF356F7EBF83552FE, 0x0583F6B8C4124D43 },
+    { 0x98165AF37B2153DE, 0xC3727A337A8B704A },
+    { 0xBE1BF1B059E9A8D6, 0x744F18C0592E4C5C },
+    { 0xEDA2EE1C7064130C, 0x1162DEF06F79DF73 },
+    { 0x9485D4D1C63E8BE7, 0x8ADDCB5645AC2BA8 },
+    { 0xB9A74A0637CE2EE1, 0x6D953E2BD7173692 },
+    { 0xE8111C87C5C1BA99, 0xC8FA8DB6CCDD0437 },
+    { 0x910AB1D4DB9914A0, 0x1D9C9892400A22A2 },
+    { 0xB54D5E4A127F59C8, 0x2503BEB6D00CAB4B },
+    { 0xE2A0B5DC971F303A, 0x2E44AE64840FD61D },
+    { 0x8DA471A9DE737E24, 0x5CEAECFED289E5D2 },
+    { 0xB10D8E1456105DAD, 0x7425A83E872C5F47 },
+    { 0xDD50F1996B947518, 0xD12F124E28F77719 },
+    { 0x8A5296FFE33CC92F, 0x82BD6B70D99AAA6F },
+    { 0xACE73CBFDC0BFB7B, 0x636CC64D1001550B },
+    { 0xD8210BEFD30EFA5A, 0x3C47F7E05401AA4E },
+    { 0x8714A775E3E95C78, 0x65ACFAEC34810A71 },
+    { 0xA8D9D1535CE3B396, 0x7F1839A741A14D0D },
+    { 0xD31045A8341CA07C, 0x1EDE48111209A050 },
+    { 0x83EA2B892091E44D, 0x934AED0AAB460432 },
+    { 0xA4E4B66B68B65D60, 0xF81DA84D5617853F },
+    { 0xCE1DE40642E3F4B9, 0x36251260AB9D668E },
+    { 0x80D2AE83E9CE78F3, 0xC1D72B7C6B426019 },
+    { 0xA1075A24E4421730, 0xB24CF65B8612F81F },
+    { 0xC94930AE1D529CFC, 0xDEE033F26797B627 },
+    { 0xFB9B7CD9A4A7443C, 0x169840EF017DA3B1 },
+    { 0x9D412E0806E88AA5, 0x8E1F289560EE864E },
+    { 0xC491798A08A2AD4E, 0xF1A6F2BAB92A27E2 },
+    { 0xF5B5D7EC8ACB58A2, 0xAE10AF696774B1DB },
+    { 0x9991A6F3D6BF1765, 0xACCA6DA1E0A8EF29 },
+    { 0xBFF610B0CC6EDD3F, 0x17FD090A58D32AF3 },
+    { 0xEFF394DCFF8A948E, 0xDDFC4B4CEF07F5B0 },
+    { 0x95F83D0A1FB69CD9, 0x4ABDAF101564F98E },
+    { 0xBB764C4CA7A4440F, 0x9D6D1AD41ABE37F1 },
+    { 0xEA53DF5FD18D5513, 0x84C86189216DC5ED },
+    { 0x92746B9BE2F8552C, 0x32FD3CF5B4E49BB4 },
+    { 0xB7118682DBB66A77, 0x3FBC8C33221DC2A1 },
+    { 0xE4D5E82392A40515, 0x0FABAF3FEAA5334A },
+    { 0x8F05B1163BA6832D, 0x29CB4D87F2A7400E },
+    { 0xB2C71D5BCA9023F8, 0x743E20E9EF511012 },
+    { 0xDF78E4B2BD342CF6, 0x914DA9246B255416 },
+    { 0x8BAB8EEFB6409C1A, 0x1AD089B6C2F7548E },
+    { 0xAE9672ABA3D0C320, 0xA184AC2473B529B1 },
+    { 0xDA3C0F568CC4F3E8, 0xC9E5D72D90A2741E },
+    { 0x8865899617FB1871, 0x7E2FA67C7A658892 },
+    { 0xAA7EEBFB9DF9DE8D, 0xDDBB901B98FEEAB7 },
+    { 0xD51EA6FA85785631, 0x552A74227F3EA565 },
+    { 0x8533285C936B35DE, 0xD53A88958F87275F },
+    { 0xA67FF273B8460356, 0x8A892ABAF368F137 },
+    { 0xD01FEF10A657842C, 0x2D2B7569B0432D85 },
+    { 0x8213F56A67F6B29B, 0x9C3B29620E29FC73 },
+    { 0xA298F2C501F45F42, 0x8349F3BA91B47B8F },
+    { 0xCB3F2F7642717713, 0x241C70A936219A73 },
+    { 0xFE0EFB53D30DD4D7, 0xED238CD383AA0110 },
+    { 0x9EC95D1463E8A506, 0xF4363804324A40AA },
+    { 0xC67BB4597CE2CE48, 0xB143C6053EDCD0D5 },
+    { 0xF81AA16FDC1B81DA, 0xDD94B7868E94050A },
+    { 0x9B10A4E5E9913128, 0xCA7CF2B4191C8326 },
+    { 0xC1D4CE1F63F57D72, 0xFD1C2F611F63A3F0 },
+    { 0xF24A01A73CF2DCCF, 0xBC633B39673C8CEC },
+    { 0x976E41088617CA01, 0xD5BE0503E085D813 },
+    { 0xBD49D14AA79DBC82, 0x4B2D8644D8A74E18 },
+    { 0xEC9C459D51852BA2, 0xDDF8E7D60ED1219E },
+    { 0x93E1AB8252F33B45, 0xCABB90E5C942B503 },
+    { 0xB8DA1662E7B00A17, 0x3D6A751F3B936243 },
+    { 0xE7109BFBA19C0C9D, 0x0CC512670A783AD4 },
+    { 0x906A617D450187E2, 0x27FB2B80668B24C5 },
+    { 0xB484F9DC9641E9DA, 0xB1F9F660802DEDF6 },
+    { 0xE1A63853BBD26451, 0x5E7873F8A0396973 },
+    { 0x8D07E33455637EB2, 0xDB0B487B6423E1E8 },
+    { 0xB049DC016ABC5E5F, 0x91CE1A9A3D2CDA62 },
+    { 0xDC5C5301C56B75F7, 0x7641A140CC7810FB },
+    { 0x89B9B3E11B6329BA, 0xA9E904C87FCB0A9D },
+    { 0xAC2820D9623BF429, 0x546345FA9FBDCD44 },
+    { 0xD732290FBACAF133, 0xA97C177947AD4095 },
+    { 0x867F59A9D4BED6C0, 0x49ED8EABCCCC485D },
+    { 0xA81F301449EE8C70, 0x5C68F256BFFF5A74 },
+    { 0xD226FC195C6A2F8C, 0x73832EEC6FFF3111 },
+    { 0x83585D8FD9C25DB7, 0xC831FD53C5FF7EAB },
+    { 0xA42E74F3D032F525, 0xBA3E7CA8B77F5E55 },
+    { 0xCD3A1230C43FB26F, 0x28CE1BD2E55F35EB },
+    { 0x80444B5E7AA7CF85, 0x7980D163CF5B81B3 },
+    { 0xA0555E361951C366, 0xD7E105BCC332621F },
+    { 0xC86AB5C39FA63440, 0x8DD9472BF3FEFAA7 },
+    { 0xFA856334878FC150, 0xB14F98F6F0FEB951 },
+    { 0x9C935E00D4B9D8D2, 0x6ED1BF9A569F33D3 },
+    { 0xC3B8358109E84F07, 0x0A862F80EC4700C8 },
+    { 0xF4A642E14C6262C8, 0xCD27BB612758C0FA },
+    { 0x98E7E9CCCFBD7DBD, 0x8038D51CB897789C },
+    { 0xBF21E44003ACDD2C, 0xE0470A63E6BD56C3 },
+    { 0xEEEA5D5004981478, 0x1858CCFCE06CAC74 },
+    { 0x95527A5202DF0CCB, 0x0F37801E0C43EBC8 },
+    { 0xBAA718E68396CFFD, 0xD30560258F54E6BA },
+    { 0xE950DF20247C83FD, 0x47C6B82EF32A2069 },
+    { 0x91D28B7416CDD27E, 0x4CDC331D57FA5441 },
+    { 0xB6472E511C81471D, 0xE0133FE4ADF8E952 },
+    { 0xE3D8F9E563A198E5, 0x58180FDDD97723A6 },
+    { 0x8E679C2F5E44FF8F, 0x570F09EAA7EA7648 }
+};
 
-    // handle invalid number
-    if (processed_chars != len)
-        throw ujson::exception(ujson::error_code::bad_number, line());
+// exact powers of ten
+static const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-    // handle overflow
-    if (!std::isfinite(result))
-        throw ujson::exception(ujson::error_code::bad_number, line());
-    return result;
+// number of leading zero bits; x must be non-zero
+static int leading_zeros(std::uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_clzll(x);
+#elif defined _MSC_VER && (defined(_M_AMD64) || defined(_M_X64))
+    unsigned long index = 0;
+    _BitScanReverse64(&index, x);
+    return 63 - static_cast<int>(index);
+#else
+    int n = 0;
+    while (!(x & (std::uint64_t(1) << 63))) {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
 }
 
-std::string parser::read_string() const {
+// full 128 bit product of a and b
+static void multiply(std::uint64_t a, std::uint64_t b, std::uint64_t &high,
+                     std::uint64_t &low) {
+#if defined __GNUC__ && defined __SIZEOF_INT128__
+    const auto product = static_cast<unsigned __int128>(a) * b;
+    high = static_cast<std::uint64_t>(product >> 64);
+    low = static_cast<std::uint64_t>(product);
+#elif defined _MSC_VER && (defined(_M_AMD64) || defined(_M_X64))
+    low = _umul128(a, b, &high);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    const auto lo_lo = a_lo * b_lo;
+    const auto hi_lo = a_hi * b_lo;
+    const auto lo_hi = a_lo * b_hi;
+    const auto cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    high = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+    low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+}
 
-    // m_token points to first double qoute and m_cursor points to last
-    auto in = m_token + 1;
-    const auto limit = m_cursor.ptr() - 1;
-    if (in == limit)
-        return "";
+// convert w * 10^q to the bits of the nearest double; w must be non-zero
+// returns false if the result cannot be rounded correctly
+static bool eisel_lemire(std::uint64_t w, std::int64_t q,
+                         std::uint64_t &bits) {
+    if (q < smallest_power_of_ten) {
+        bits = 0;
+        return true;
+    }
+    if (q > largest_power_of_ten) {
+        bits = std::uint64_t(0x7FF) << 52;
+        return true;
+    }
 
-    // limit-in is an upper bound on the size of the resulting string
-    std::string result(limit - in, '\0');
-    char *out = &result.front();
+    const int lz = leading_zeros(w);
+    w <<= lz;
 
-    while (in < limit) {
+    // 55 bits are needed: 53 for the significand, one to tell if it
+    // rounds up and one as the product may have a leading zero
+    const auto &power = power_of_five_128[q - smallest_power_of_ten];
+    std::uint64_t high, low;
+    multiply(w, power[0], high, low);
+    const std::uint64_t precision_mask = ~std::uint64_t(0) >> 55;
+    if ((high & precision_mask) == precision_mask) {
+        std::uint64_t second_high, second_low;
+        multiply(w, power[1], second_high, second_low);
+        low += second_high;
+        if (second_high > low)
+            ++high;
+        if (low == ~std::uint64_t(0) && (q < -27 || q > 55))
+            return false;
+    }
 
-#ifdef UJSON_USE_SSE2
-        while (limit - in >= 16) {
-            __m128i backslash = _mm_set1_epi8(0x5C);
-            __m128i chunk =
-                _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
-            __m128i compare = _mm_cmpeq_epi8(chunk, backslash);
-            int mask = _mm_movemask_epi8(compare);
-            if (!mask) {
-                in += 16;
-                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), chunk);
-                out += 16;
-                continue;
-            }
+    const int upper_bit = static_cast<int>(high >> 63);
+    std::uint64_t mantissa = high >> (upper_bit + 9);
 
-#ifdef __GNUC__
-            int index = __builtin_ffs(mask) - 1;
-#else
-            unsigned long index = 0;
-            _BitScanForward(&index, mask);
-#endif
-            assert(index >= 0 && index <= 15);
-            for (decltype(index) i = 0; i < index; ++i)
-                *out++ = *in++;
-            break;
+    // floor(log2(10^q)) + 63, then biased
+    std::int64_t power2 =
+        ((217706 * q) >> 16) + 63 + upper_bit - lz + 1023;
+
+    if (power2 <= 0) {
+        // subnormal
+        if (-power2 + 1 >= 64) {
+            bits = 0;
+            return true;
         }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (std::uint64_t(1) << 52) ? 0 : 1;
+        bits = mantissa | (static_cast<std::uint64_t>(power2) << 52);
+        return true;
+    }
 
-        if (in == limit)
-            break;
+    // exactly halfway between two doubles; round to even
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+        (mantissa << (upper_bit + 9)) == high)
+        mantissa &= ~std::uint64_t(1);
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (std::uint64_t(2) << 52)) {
+        mantissa = std::uint64_t(1) << 52;
+        ++power2;
+    }
+    mantissa &= ~(std::uint64_t(1) << 52);
+    if (power2 >= 0x7FF)
+        power2 = 0x7FF, mantissa = 0;
+    bits = mantissa | (static_cast<std::uint64_t>(power2) << 52);
+    return true;
+}
+
+// true if the eight bytes in x are all digits
+static bool is_eight_digits(std::uint64_t x) {
+    return ((x & 0xF0F0F0F0F0F0F0F0) |
+            (((x + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
+}
+
+// value of eight digits in x, first digit in the low byte
+static std::uint32_t parse_eight_digits(std::uint64_t x) {
+    x -= 0x3030303030303030;
+    x = x * 10 + (x >> 8);
+    x = (((x & 0x000000FF000000FF) * 0x000F424000000064) +
+         (((x >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >>
+        32;
+    return static_cast<std::uint32_t>(x);
+}
+
+// convert significand * 10^exponent to a double; returns false if it is
+// left to double-conversion
+static bool to_double(std::uint64_t significand, std::int64_t exponent,
+                      double &result) {
+    if (significand == 0) {
+        result = 0.0;
+        return true;
+    }
 
+    // Clinger's fast path: a single correctly rounded operation, but only
+    // without extended precision intermediates
+#if FLT_EVAL_METHOD == 0
+    if (significand <= (std::uint64_t(1) << 53) && exponent >= -22 &&
+        exponent <= 22) {
+        result = static_cast<double>(significand);
+        if (exponent < 0)
+            result /= exact_powers_of_ten[-exponent];
+        else
+            result *= exact_powers_of_ten[exponent];
+        return true;
+    }
 #endif
-        char c = *in++;
-        if (c != '\\') {
-            *out++ = c;
-        } else {
-            c = *in++;
-            if (c == '\\')
-                *out++ = '\\';
-            else if (c == '"')
-                *out++ = '"';
-            else if (c == '/')
-                *out++ = '/';
-            else if (c == 'b')
-                *out++ = '\b';
-            else if (c == 'f')
-                *out++ = '\f';
-            else if (c == 'n')
-                *out++ = '\n';
-            else if (c == 'r')
-                *out++ = '\r';
-            else if (c == 't')
-                *out++ = '\t';
-            else if (c == 'u') {
-                std::uint32_t cp = hex_to_int(in);
-                in += 4;
-
-                // surrogate pair?
-                if (cp >= 0xD800 && cp <= 0xDBFF) {
-                    in += 2;
-                    std::uint32_t trailing = hex_to_int(in);
-                    in += 4;
-                    assert(trailing >= 0xDC00 && trailing <= 0xDFFF);
-                    cp =
-                        ((cp - 0xD800) << 10) + (trailing - 0xDC00) + 0x10000;
-                }
 
-                // translate to 1-4 utf-8 chars
-                out = utf32_to_utf8(out, cp);
-            } else {
-                // can't happen unless regexes are wrong
-                assert(false);
-            }
+    std::uint64_t bits;
+    if (!eisel_lemire(significand, exponent, bits))
+        return false;
+    std::memcpy(&result, &bits, sizeof(result));
+    return true;
+}
+
+double ujson::reader::read_double() const {
+
+    double result;
+    if (!m_many_digits && to_double(m_significand, m_exponent, result)) {
+        if (m_negative)
+            result = -result;
+    } else {
+        const auto len = static_cast<int>(m_cursor - m_token);
+
+        using namespace double_conversion;
+        static const StringToDoubleConverter s2dc(
+            StringToDoubleConverter::NO_FLAGS, 0.0, 0.0, nullptr, nullptr);
+        int processed_chars;
+        auto token = reinterpret_cast<const char *>(m_token);
+        result = s2dc.StringToDouble(token, len, &processed_chars);
+
+        // handle invalid number
+        if (processed_chars != len) {
+            fail(ujson::error_code::bad_number);
+            return 0;
         }
     }
 
-    result.resize(out - result.data());
+    // handle overflow
+    if (!std::isfinite(result)) {
+        fail(ujson::error_code::bad_number);
+        return 0;
+    }
     return result;
 }
 
-//----------------------------------------------------------------------------
+bool ujson::reader::read_int64(std::int64_t &i) const {
+    const auto max = std::uint64_t(std::numeric_limits<std::int64_t>::max());
+    if (!m_integer || m_significand > max + m_negative)
+        return false;
+    if (m_significand > max)
+        i = std::numeric_limits<std::int64_t>::min();
+    else if (m_negative)
+        i = -static_cast<std::int64_t>(m_significand);
+    else
+        i = static_cast<std::int64_t>(m_significand);
+    return true;
+}
 
-token parser::scan() {
-    safe_ptr marker(m_cursor, m_limit);
+bool ujson::reader::read_uint64(std::uint64_t &u) const {
+    if (!m_integer || m_negative)
+        return false;
+    u = m_significand;
+    return true;
+}
 
-std:
-#ifdef UJSON_USE_SSE2
-    while (m_limit - m_cursor.ptr() >= 16) {
+ujson::value ujson::reader::read_raw_number() const {
+    return value::make_raw_number(reinterpret_cast<const char *>(m_token),
+                                  m_cursor - m_token);
+}
+
+std::string ujson::reader::read_string() const {
+    std::string result;
+    read_string(result);
+    return result;
+}
+
+void ujson::reader::read_string(std::string &result) const {
+
+    // strings with escapes were unescaped to m_buffer while scanning; the
+    // existing capacity of result is reused if large enough
+    if (m_escaped) {
+        result.assign(m_buffer);
+        return;
+    }
 
-        __m128i chunk = _mm_loadu_si128(
-            reinterpret_cast<const __m128i *>(m_cursor.ptr()));
+    // m_token points to first double qoute and m_cursor points past last
+    result.assign(reinterpret_cast<const char *>(m_token + 1),
+                  m_cursor - m_token - 2);
+}
+
+ujson::string_view ujson::reader::read_string_view() {
+    if (m_escaped)
+        return { m_buffer.data(), m_buffer.length() };
+    return { reinterpret_cast<const char *>(m_token + 1),
+             static_cast<std::size_t>(m_cursor - m_token - 2) };
+}
 
-        __m128i tabs = _mm_set1_epi8(0x09);
-        __m128i newlines = _mm_set1_epi8(0x0A);
-        __m128i carriage_return = _mm_set1_epi8(0x0D);
-        __m128i spaces = _mm_set1_epi8(0x20);
+ujson::value ujson::reader::read_borrowed_string() {
+    if (m_escaped)
+        return value(m_buffer, validate_utf8::no);
+    return value::make_borrowed_string(
+        reinterpret_cast<const char *>(m_token + 1),
+        static_cast<std::size_t>(m_cursor - m_token - 2));
+}
 
-        __m128i is_tabs = _mm_cmpeq_epi8(chunk, tabs);
-        __m128i is_newlines = _mm_cmpeq_epi8(chunk, newlines);
-        __m128i is_carriage_return = _mm_cmpeq_epi8(chunk, carriage_return);
-        __m128i is_space = _mm_cmpeq_epi8(chunk, spaces);
+ujson::value ujson::reader::read_string_insitu(char *buffer) {
+    // unescaped contents are never longer than the token, so they fit
+    // between the quotes
+    auto first = buffer + (m_token + 1 - m_start);
+    auto len = static_cast<std::size_t>(m_cursor - m_token - 2);
+    if (m_escaped) {
+        len = m_buffer.length();
+        std::memcpy(first, m_buffer.data(), len);
+        m_insitu_lines += std::count(first, first + len, '\n');
+    }
+    first[len] = 0;
+    return value::make_borrowed_string(first, len);
+}
 
-        __m128i is_white_space =
-            _mm_or_si128(_mm_or_si128(is_tabs, is_newlines),
-                         _mm_or_si128(is_carriage_return, is_space));
+void ujson::reader::skip_value() {
 
-        int mask = _mm_movemask_epi8(is_white_space);
-        if (mask == 0xFFFF) {
-            m_cursor += 16;
+    // whether each enclosing container is an object; only nesting past the
+    // default parse_options::max_depth spills to the heap
+    std::bitset<1024> is_object;
+    std::vector<bool> deeper;
+    std::size_t depth = 0;
+    auto innermost_is_object = [&] {
+        return depth <= is_object.size() ? is_object[depth - 1]
+                                         : deeper[depth - 1 - is_object.size()];
+    };
+    for (;;) {
+        auto t = read_token();
+        switch (t) {
+        case token::null:
+        case token::true_value:
+        case token::false_value:
+        case token::number:
+        case token::string:
+            break;
+        case token::array_begin:
+        case token::object_begin: {
+            const bool object = t == token::object_begin;
+            const auto end = object ? token::object_end : token::array_end;
+            if (peek_token() == end) {
+                read_token();
+                break;
+            }
+            if (depth < is_object.size())
+                is_object[depth] = object;
+            else
+                deeper.push_back(object);
+            ++depth;
+            if (object) {
+                expect(token::string);
+                expect(token::colon);
+            }
             continue;
         }
+        default:
+            scan_error();
+            return;
+        }
 
-#ifdef __GNUC__
-        m_cursor += __builtin_ffs(~mask) - 1;
-#else
-        unsigned long index = 0;
-        if (_BitScanForward(&index, ~mask))
-            m_cursor += index;
-#endif
+        // after a value: a comma or the end of the innermost container
+        for (;;) {
+            if (depth == 0)
+                return;
+            const bool object = innermost_is_object();
+            t = read_token();
+            if (t == token::comma) {
+                if (object) {
+                    expect(token::string);
+                    expect(token::colon);
+                }
+                break;
+            }
+            if (t != (object ? token::object_end : token::array_end)) {
+                scan_error();
+                return;
+            }
+            if (depth > is_object.size())
+                deeper.pop_back();
+            --depth;
+        }
+    }
+}
+
+void ujson::reader::skip_value_unchecked() {
+    switch (read_token()) {
+    case token::null:
+    case token::true_value:
+    case token::false_value:
+    case token::number:
+    case token::string:
+        return;
+    case token::array_begin:
+    case token::object_begin:
+        skip_unchecked(1);
+        return;
+    default:
+        scan_error();
+    }
+}
+
+void ujson::reader::skip_unchecked(std::size_t depth) {
+    auto ptr = m_cursor;
+    while (ptr < m_limit) {
+        switch (*ptr++) {
+        case '"':
+            // jump to the closing quote, which follows an even number of
+            // backslashes; the opening quote ends the backward search
+            for (;;) {
+                auto quote = static_cast<const std::uint8_t *>(std::memchr(
+                    ptr, '"', static_cast<std::size_t>(m_limit - ptr)));
+                if (!quote) {
+                    scan_error();
+                    return;
+                }
+                ptr = quote + 1;
+                auto run = quote;
+                while (run[-1] == '\\')
+                    --run;
+                if ((quote - run) % 2 == 0)
+                    break;
+            }
+            break;
+        case '[':
+        case '{':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (--depth == 0) {
+                m_peeked = false;
+                m_current_token =
+                    ptr[-1] == ']' ? token::array_end : token::object_end;
+                m_token = ptr - 1;
+                m_cursor = ptr;
+                return;
+            }
+            break;
+        }
+    }
+    m_cursor = m_limit;
+    fail(ujson::error_code::invalid_syntax);
+}
+
+//----------------------------------------------------------------------------
+
+void ujson::reader::classify(const std::uint8_t *block) {
+
+    // unless the input is padded, copy the tail to a zero padded block so
+    // we never read past the limit
+    std::uint8_t tail[64];
+    const std::uint8_t *ptr = block;
+    if (!m_padded && m_limit - block < 64) {
+        std::memset(tail, 0, sizeof(tail));
+        std::memcpy(tail, block, m_limit - block);
+        ptr = tail;
+    }
+
+    const auto bits = kernels->classify(ptr);
+    m_block = block;
+    m_whitespace = bits.whitespace;
+    m_quotes = bits.quotes;
+    m_special = bits.special;
+    m_non_ascii = bits.non_ascii;
+}
+
+// true if the four bytes at ptr are hex digits
+static bool is_hex(const std::uint8_t *ptr) {
+    for (int i = 0; i < 4; ++i) {
+        const auto c = ptr[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+              (c >= 'a' && c <= 'f')))
+            return false;
+    }
+    return true;
+}
+
+// append the escape sequence starting with the backslash at ptr to out;
+// returns the end of the sequence or nullptr if it is invalid
+static const std::uint8_t *unescape(const std::uint8_t *ptr,
+                                    const std::uint8_t *limit,
+                                    std::string &out) {
+    if (limit - ptr < 2)
+        return nullptr;
+
+    switch (ptr[1]) {
+    case '"':
+        out.push_back('"');
+        return ptr + 2;
+    case '\\':
+        out.push_back('\\');
+        return ptr + 2;
+    case '/':
+        out.push_back('/');
+        return ptr + 2;
+    case 'b':
+        out.push_back('\b');
+        return ptr + 2;
+    case 'f':
+        out.push_back('\f');
+        return ptr + 2;
+    case 'n':
+        out.push_back('\n');
+        return ptr + 2;
+    case 'r':
+        out.push_back('\r');
+        return ptr + 2;
+    case 't':
+        out.push_back('\t');
+        return ptr + 2;
+    case 'u':
         break;
+    default:
+        return nullptr;
+    }
+
+    if (limit - ptr < 6 || !is_hex(ptr + 2))
+        return nullptr;
+    std::uint32_t cp = hex_to_int(ptr + 2);
+    ptr += 6;
+
+    // surrogates must come in pairs
+    if (cp >= 0xDC00 && cp <= 0xDFFF)
+        return nullptr;
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        if (limit - ptr < 6 || ptr[0] != '\\' || ptr[1] != 'u' ||
+            !is_hex(ptr + 2))
+            return nullptr;
+        std::uint32_t trailing = hex_to_int(ptr + 2);
+        if (trailing < 0xDC00 || trailing > 0xDFFF)
+            return nullptr;
+        cp = ((cp - 0xD800) << 10) + (trailing - 0xDC00) + 0x10000;
+        ptr += 6;
+    }
+
+    // translate to 1-4 utf-8 chars
+    char utf8[4];
+    out.append(utf8, utf32_to_utf8(utf8, cp));
+    return ptr;
+}
+
+token ujson::reader::scan_string(const std::uint8_t *first) {
+
+    // a single pass finds the end of the string and, from the first escape
+    // sequence on, writes the unescaped contents to m_buffer; runs between
+    // escapes are skipped a block at a time and validated as utf-8 by the
+    // lookup kernel if they have any non-ascii bytes
+    m_escaped = false;
+    auto ptr = first + 1;
+    auto run = ptr;
+    bool non_ascii = false;
+    for (;;) {
+        while (ptr < m_limit) {
+            if (ptr >= m_block + 64)
+                classify(ptr);
+            const auto offset = ptr - m_block;
+            auto stop = (m_quotes | m_special) >> offset;
+            auto high = m_non_ascii >> offset;
+            if (stop) {
+                const int n = trailing_zeros(stop);
+                non_ascii |= (high & ((std::uint64_t(1) << n) - 1)) != 0;
+                ptr += n;
+                break;
+            }
+            non_ascii |= high != 0;
+            ptr = m_block + 64;
+        }
+        if (ptr >= m_limit)
+            break;
+
+        if (non_ascii &&
+            !kernels->validate_utf8(reinterpret_cast<const char *>(run),
+                                    ptr - run))
+            break;
+        non_ascii = false;
+
+        const auto c = *ptr;
+        if (c == '"') {
+            if (m_escaped)
+                m_buffer.append(reinterpret_cast<const char *>(run),
+                                ptr - run);
+            m_cursor = ptr + 1;
+            return token::string;
+        } else if (c == '\\') {
+            if (!m_escaped) {
+                m_buffer.clear();
+                m_escaped = true;
+            }
+            m_buffer.append(reinterpret_cast<const char *>(run), ptr - run);
+            ptr = unescape(ptr, m_limit, m_buffer);
+            if (!ptr)
+                break;
+            run = ptr;
+        } else {
+            // control characters must be escaped
+            break;
+        }
+    }
+
+    return scan_error();
+}
+
+token ujson::reader::scan_number(const std::uint8_t *first) {
+
+    // collect the significand and exponent while validating the number;
+    // like the dfa this matches the longest valid number, so "1." is the
+    // number 1 followed by an invalid token
+    auto ptr = first;
+    m_negative = *ptr == '-';
+    if (m_negative)
+        ++ptr;
+    if (ptr == m_limit || *ptr < '0' || *ptr > '9')
+        return scan_error();
+
+    std::uint64_t significand = 0;
+    const auto digits_first = ptr;
+    if (*ptr == '0') {
+        ++ptr;
+    } else {
+        while ((m_padded || m_limit - ptr >= 8) &&
+               is_eight_digits(load_word(ptr))) {
+            significand =
+                significand * 100000000 + parse_eight_digits(load_word(ptr));
+            ptr += 8;
+        }
+        while (ptr < m_limit && *ptr >= '0' && *ptr <= '9')
+            significand = significand * 10 + (*ptr++ - '0');
+    }
+    auto digits = ptr - digits_first;
+
+    // integers up to 2^64 - 1 are exact; "-0" is kept as a double
+    m_integer = digits < 20 ||
+                (digits == 20 && std::memcmp(digits_first,
+                                             "18446744073709551615", 20) <= 0);
+    m_integer = m_integer && !(m_negative && significand == 0);
+
+    std::int64_t exponent = 0;
+    if (ptr + 1 < m_limit && *ptr == '.' && ptr[1] >= '0' && ptr[1] <= '9') {
+        const auto fraction_first = ++ptr;
+        while ((m_padded || m_limit - ptr >= 8) &&
+               is_eight_digits(load_word(ptr))) {
+            significand =
+                significand * 100000000 + parse_eight_digits(load_word(ptr));
+            ptr += 8;
+        }
+        while (ptr < m_limit && *ptr >= '0' && *ptr <= '9')
+            significand = significand * 10 + (*ptr++ - '0');
+        exponent = -(ptr - fraction_first);
+        digits += ptr - fraction_first;
+        m_integer = false;
+    }
+
+    if (ptr < m_limit && (*ptr == 'e' || *ptr == 'E')) {
+        auto exponent_first = ptr + 1;
+        bool negative = false;
+        if (exponent_first < m_limit &&
+            (*exponent_first == '-' || *exponent_first == '+')) {
+            negative = *exponent_first == '-';
+            ++exponent_first;
+        }
+        if (exponent_first < m_limit && *exponent_first >= '0' &&
+            *exponent_first <= '9') {
+            // saturate; any exponent this large over or underflows
+            std::int64_t value = 0;
+            for (ptr = exponent_first;
+                 ptr < m_limit && *ptr >= '0' && *ptr <= '9'; ++ptr)
+                if (value < 0x10000000)
+                    value = value * 10 + (*ptr - '0');
+            exponent += negative ? -value : value;
+            m_integer = false;
+        }
+    }
+
+    // leading zeros of the fraction are not significant
+    if (digits > 19) {
+        auto it = digits_first;
+        while (it < ptr && (*it == '0' || *it == '.')) {
+            if (*it == '0')
+                --digits;
+            ++it;
+        }
+    }
+
+    m_significand = significand;
+    m_exponent = exponent;
+    m_many_digits = digits > 19;
+    m_cursor = ptr;
+    return token::number;
+}
+
+token ujson::reader::scan() {
+
+    // matching the sentinel moves the cursor one past the limit; move it back
+    // so reading past the end keeps returning eof
+    if (m_cursor > m_limit)
+        m_cursor = m_limit;
+
+    // skip white space a block at a time
+    auto ptr = m_cursor;
+    while (ptr < m_limit) {
+        if (ptr < m_block || ptr >= m_block + 64)
+            classify(ptr);
+        auto other = ~m_whitespace >> (ptr - m_block);
+        if (other) {
+            ptr += trailing_zeros(other);
+            break;
+        }
+        ptr = m_block + 64;
+    }
+    m_cursor = ptr;
+    m_token = ptr;
+
+    if (ptr < m_limit && *ptr == '"')
+        return scan_string(ptr);
+    if (ptr < m_limit && (*ptr == '-' || (*ptr >= '0' && *ptr <= '9')))
+        return scan_number(ptr);
+
+    // the dfa can read the terminating zero of padded input directly
+    if (m_padded) {
+        auto cursor = ptr;
+        auto t = scan(cursor);
+        m_cursor = cursor;
+        return t;
     }
-#endif
 
-    m_token = m_cursor.ptr();
+    safe_ptr cursor(ptr, m_limit);
+    auto t = scan(cursor);
+    m_cursor = cursor.ptr();
+    return t;
+}
+
+template <typename cursor_type>
+token ujson::reader::scan(cursor_type &cursor) {
 
+    cursor_type marker = cursor;
+
+    // strings, numbers and white space never get here, scan() handles them
     
 {
     std::uint8_t yych;
-    unsigned int yyaccept = 0;
 
-    yych = *m_cursor;
+    yych = *cursor;
     switch (yych) {
     case 0x00:    goto ujson25;
-    case '\t':
-    case '\n':
-    case '\r':
-    case ' ':    goto ujson23;
-    case '"':    goto ujson22;
     case ',':    goto ujson4;
-    case '-':    goto ujson18;
-    case '0':    goto ujson19;
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson21;
     case ':':    goto ujson2;
     case '[':    goto ujson10;
     case ']':    goto ujson12;
@@ -823,2221 +2742,2409 @@ std:
     default:    goto ujson27;
     }
 ujson2:
-    ++m_cursor;
-    { return ujson_colon; }
+    ++cursor;
+    { return token::colon; }
 ujson4:
-    ++m_cursor;
-    { return ujson_comma; }
+    ++cursor;
+    { return token::comma; }
 ujson6:
-    yyaccept = 0;
-    yych = *(marker = ++m_cursor);
+    yych = *(marker = ++cursor);
     switch (yych) {
     case 'u':    goto ujson91;
     default:    goto ujson7;
     }
 ujson7:
     {
-        throw ujson::exception(ujson::error_code::invalid_syntax, line());
+        cursor = m_limit;
+        return scan_error();
      }
 ujson8:
-    yyaccept = 0;
-    yych = *(marker = ++m_cursor);
+    yych = *(marker = ++cursor);
     switch (yych) {
     case 'r':    goto ujson87;
     default:    goto ujson7;
     }
 ujson9:
-    yyaccept = 0;
-    yych = *(marker = ++m_cursor);
+    yych = *(marker = ++cursor);
     switch (yych) {
     case 'a':    goto ujson82;
     default:    goto ujson7;
     }
 ujson10:
-    ++m_cursor;
-    { return ujson_array_begin; }
+    ++cursor;
+    { return token::array_begin; }
 ujson12:
-    ++m_cursor;
-    { return ujson_array_end; }
+    ++cursor;
+    { return token::array_end; }
 ujson14:
-    ++m_cursor;
-    { return ujson_object_begin; }
+    ++cursor;
+    { return token::object_begin; }
 ujson16:
-    ++m_cursor;
-    { return ujson_object_end; }
-ujson18:
-    yych = *++m_cursor;
-    switch (yych) {
-    case '0':    goto ujson81;
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson72;
-    default:    goto ujson7;
-    }
-ujson19:
-    yyaccept = 1;
-    yych = *(marker = ++m_cursor);
-    switch (yych) {
-    case '.':    goto ujson74;
-    case 'E':
-    case 'e':    goto ujson75;
-    default:    goto ujson20;
-    }
-ujson20:
-    { return ujson_number; }
-ujson21:
-    yyaccept = 1;
-    yych = *(marker = ++m_cursor);
-    goto ujson73;
-ujson22:
-    yyaccept = 0;
-    yych = *(marker = ++m_cursor);
-    switch (yych) {
-    case ' ':
-    case '!':
-    case '"':
-    case '#':
-    case '$':
-    case '%':
-    case '&':
-    case '\'':
-    case '(':
-    case ')':
-    case '*':
-    case '+':
-    case ',':
-    case '-':
-    case '.':
-    case '/':
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case ':':
-    case ';':
-    case '<':
-    case '=':
-    case '>':
-    case '?':
-    case '@':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'G':
-    case 'H':
-    case 'I':
-    case 'J':
-    case 'K':
-    case 'L':
-    case 'M':
-    case 'N':
-    case 'O':
-    case 'P':
-    case 'Q':
-    case 'R':
-    case 'S':
-    case 'T':
-    case 'U':
-    case 'V':
-    case 'W':
-    case 'X':
-    case 'Y':
-    case 'Z':
-    case '[':
-    case '\\':
-    case ']':
-    case '^':
-    case '_':
-    case '`':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':
-    case 'g':
-    case 'h':
-    case 'i':
-    case 'j':
-    case 'k':
-    case 'l':
-    case 'm':
-    case 'n':
-    case 'o':
-    case 'p':
-    case 'q':
-    case 'r':
-    case 's':
-    case 't':
-    case 'u':
-    case 'v':
-    case 'w':
-    case 'x':
-    case 'y':
-    case 'z':
-    case '{':
-    case '|':
-    case '}':
-    case '~':
-    case 0x7F:
-    case 0xC2:
-    case 0xC3:
-    case 0xC4:
-    case 0xC5:
-    case 0xC6:
-    case 0xC7:
-    case 0xC8:
-    case 0xC9:
-    case 0xCA:
-    case 0xCB:
-    case 0xCC:
-    case 0xCD:
-    case 0xCE:
-    case 0xCF:
-    case 0xD0:
-    case 0xD1:
-    case 0xD2:
-    case 0xD3:
-    case 0xD4:
-    case 0xD5:
-    case 0xD6:
-    case 0xD7:
-    case 0xD8:
-    case 0xD9:
-    case 0xDA:
-    case 0xDB:
-    case 0xDC:
-    case 0xDD:
-    case 0xDE:
-    case 0xDF:
-    case 0xE0:
-    case 0xE1:
-    case 0xE2:
-    case 0xE3:
-    case 0xE4:
-    case 0xE5:
-    case 0xE6:
-    case 0xE7:
-    case 0xE8:
-    case 0xE9:
-    case 0xEA:
-    case 0xEB:
-    case 0xEC:
-    case 0xED:
-    case 0xEE:
-    case 0xEF:
-    case 0xF0:
-    case 0xF1:
-    case 0xF2:
-    case 0xF3:
-    case 0xF4:    goto ujson31;
-    default:    goto ujson7;
-    }
-ujson23:
-    ++m_cursor;
-    yych = *m_cursor;
-    goto ujson29;
-ujson24:
-    { goto std; }
+    ++cursor;
+    { return token::object_end; }
 ujson25:
-    ++m_cursor;
-    { return ujson_eof; }
+    ++cursor;
+    { return token::eof; }
 ujson27:
-    yych = *++m_cursor;
+    yych = *++cursor;
     goto ujson7;
-ujson28:
-    ++m_cursor;
-    yych = *m_cursor;
-ujson29:
-    switch (yych) {
-    case '\t':
-    case '\n':
-    case '\r':
-    case ' ':    goto ujson28;
-    default:    goto ujson24;
-    }
-ujson30:
-    ++m_cursor;
-    yych = *m_cursor;
-ujson31:
-    switch (yych) {
-    case ' ':
-    case '!':
-    case '#':
-    case '$':
-    case '%':
-    case '&':
-    case '\'':
-    case '(':
-    case ')':
-    case '*':
-    case '+':
-    case ',':
-    case '-':
-    case '.':
-    case '/':
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case ':':
-    case ';':
-    case '<':
-    case '=':
-    case '>':
-    case '?':
-    case '@':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'G':
-    case 'H':
-    case 'I':
-    case 'J':
-    case 'K':
-    case 'L':
-    case 'M':
-    case 'N':
-    case 'O':
-    case 'P':
-    case 'Q':
-    case 'R':
-    case 'S':
-    case 'T':
-    case 'U':
-    case 'V':
-    case 'W':
-    case 'X':
-    case 'Y':
-    case 'Z':
-    case '[':
-    case ']':
-    case '^':
-    case '_':
-    case '`':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':
-    case 'g':
-    case 'h':
-    case 'i':
-    case 'j':
-    case 'k':
-    case 'l':
-    case 'm':
-    case 'n':
-    case 'o':
-    case 'p':
-    case 'q':
-    case 'r':
-    case 's':
-    case 't':
-    case 'u':
-    case 'v':
-    case 'w':
-    case 'x':
-    case 'y':
-    case 'z':
-    case '{':
-    case '|':
-    case '}':
-    case '~':
-    case 0x7F:    goto ujson30;
-    case '"':    goto ujson42;
-    case '\\':    goto ujson33;
-    case 0xC2:
-    case 0xC3:
-    case 0xC4:
-    case 0xC5:
-    case 0xC6:
-    case 0xC7:
-    case 0xC8:
-    case 0xC9:
-    case 0xCA:
-    case 0xCB:
-    case 0xCC:
-    case 0xCD:
-    case 0xCE:
-    case 0xCF:
-    case 0xD0:
-    case 0xD1:
-    case 0xD2:
-    case 0xD3:
-    case 0xD4:
-    case 0xD5:
-    case 0xD6:
-    case 0xD7:
-    case 0xD8:
-    case 0xD9:
-    case 0xDA:
-    case 0xDB:
-    case 0xDC:
-    case 0xDD:
-    case 0xDE:
-    case 0xDF:    goto ujson34;
-    case 0xE0:    goto ujson35;
-    case 0xE1:
-    case 0xE2:
-    case 0xE3:
-    case 0xE4:
-    case 0xE5:
-    case 0xE6:
-    case 0xE7:
-    case 0xE8:
-    case 0xE9:
-    case 0xEA:
-    case 0xEB:
-    case 0xEC:    goto ujson36;
-    case 0xED:    goto ujson37;
-    case 0xEE:
-    case 0xEF:    goto ujson38;
-    case 0xF0:    goto ujson39;
-    case 0xF1:
-    case 0xF2:
-    case 0xF3:    goto ujson40;
-    case 0xF4:    goto ujson41;
-    default:    goto ujson32;
-    }
 ujson32:
-    m_cursor = marker;
-    switch (yyaccept) {
-    case 0: 	goto ujson7;
-    case 1: 	goto ujson20;
-    }
-ujson33:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '"':
-    case '/':
-    case '\\':
-    case 'b':
-    case 'f':
-    case 'n':
-    case 'r':
-    case 't':    goto ujson30;
-    case 'u':    goto ujson54;
-    default:    goto ujson32;
-    }
-ujson34:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
-    }
-ujson35:
-    ++m_cursor;
-    yych = *m_cursor;
+    cursor = marker;
+    goto ujson7;
+ujson82:
+    yych = *++cursor;
     switch (yych) {
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson53;
+    case 'l':    goto ujson83;
     default:    goto ujson32;
     }
-ujson36:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson83:
+    yych = *++cursor;
     switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson52;
+    case 's':    goto ujson84;
     default:    goto ujson32;
     }
-ujson37:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson84:
+    yych = *++cursor;
     switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:    goto ujson51;
+    case 'e':    goto ujson85;
     default:    goto ujson32;
     }
-ujson38:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson85:
+    ++cursor;
+    { return token::false_value; }
+ujson87:
+    yych = *++cursor;
     switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson50;
+    case 'u':    goto ujson88;
     default:    goto ujson32;
     }
-ujson39:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson88:
+    yych = *++cursor;
     switch (yych) {
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson48;
+    case 'e':    goto ujson89;
     default:    goto ujson32;
     }
-ujson40:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson89:
+    ++cursor;
+    { return token::true_value; }
+ujson91:
+    yych = *++cursor;
     switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson46;
+    case 'l':    goto ujson92;
     default:    goto ujson32;
     }
-ujson41:
-    ++m_cursor;
-    yych = *m_cursor;
+ujson92:
+    yych = *++cursor;
     switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:    goto ujson44;
+    case 'l':    goto ujson93;
     default:    goto ujson32;
     }
-ujson42:
-    ++m_cursor;
-    { return ujson_string; }
-ujson44:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson45;
-    default:    goto ujson32;
+ujson93:
+    ++cursor;
+    { return token::null; }
+}
+
+}
+
+//----------------------------------------------------------------------------
+
+// value of last consumed number token
+static ujson::value read_number(ujson::reader &reader,
+                                const ujson::parse_options &opts) {
+    if (opts.raw_numbers)
+        return reader.read_raw_number();
+    std::int64_t i;
+    std::uint64_t u;
+    if (reader.read_int64(i))
+        return i;
+    if (reader.read_uint64(u))
+        return u;
+    return reader.read_double();
+}
+
+namespace {
+
+// array or object being built, with the name of the member being parsed
+struct frame {
+    explicit frame(bool is_object = false) : is_object(is_object) {}
+
+    bool is_object;
+    ujson::array array;
+    ujson::object object;
+    std::string key;
+};
+
+// stable sort by name; small objects use insertion sort, which avoids the
+// temporary buffer std::stable_sort allocates
+template <typename iterator> void sort_members(iterator first, iterator last) {
+    if (last - first > 32) {
+        std::stable_sort(first, last);
+        return;
     }
-ujson45:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+    for (auto it = first; it != last; ++it)
+        std::rotate(std::upper_bound(first, it, *it), it, it + 1);
+}
+}
+
+// whether another array or object may be opened inside depth others;
+// fails with too_deep otherwise
+static bool check_depth(std::size_t depth, const ujson::parse_options &opts,
+                        const ujson::reader &reader) {
+    if (depth < opts.max_depth)
+        return true;
+    reader.fail(ujson::error_code::too_deep);
+    return false;
+}
+
+// consume the name and colon of an object member
+static void read_key(ujson::reader &reader, std::string &key) {
+    reader.expect(token::string);
+    if (reader.failed())
+        return;
+    reader.read_string(key);
+    reader.expect(token::colon);
+}
+
+// parse a value using an explicit stack of open containers
+// insitu is the writable input for parse_insitu, null otherwise
+static ujson::value parse_value(ujson::reader &reader,
+                                const ujson::parse_options &opts,
+                                char *insitu = nullptr) {
+    // frames above depth are closed and kept for reuse with their buffers
+    std::vector<frame> stack;
+    std::size_t depth = 0;
+    auto push = [&](bool is_object) -> frame & {
+        if (depth == stack.size())
+            stack.emplace_back();
+        auto &top = stack[depth++];
+        top.is_object = is_object;
+        return top;
+    };
+    for (;;) {
+        // parse a scalar, or open a container and continue with its first
+        // element
+        ujson::value value;
+        switch (reader.read_token()) {
+        case token::null:
+            break;
+        case token::true_value:
+            value = true;
+            break;
+        case token::false_value:
+            value = false;
+            break;
+        case token::number:
+            value = read_number(reader, opts);
+            break;
+        case token::string:
+            if (insitu)
+                value = reader.read_string_insitu(insitu);
+            else if (opts.borrowed_strings)
+                value = reader.read_borrowed_string();
+            else
+                value = ujson::value(reader.read_string(),
+                                     ujson::validate_utf8::no);
+            break;
+        case token::array_begin:
+            if (!check_depth(depth, opts, reader))
+                return ujson::value();
+            if (reader.peek_token() != token::array_end) {
+                push(false);
+                continue;
+            }
+            reader.read_token();
+            value = ujson::array();
+            break;
+        case token::object_begin:
+            if (!check_depth(depth, opts, reader))
+                return ujson::value();
+            if (reader.peek_token() != token::object_end) {
+                read_key(reader, push(true).key);
+                continue;
+            }
+            reader.read_token();
+            value = ujson::object();
+            break;
+        default:
+            reader.fail(ujson::error_code::invalid_syntax);
+            return ujson::value();
+        }
+
+        // stop at the first recorded error, such as a bad number
+        if (reader.failed())
+            return ujson::value();
+
+        // add value to the innermost container, closing those that end
+        for (;;) {
+            if (depth == 0)
+                return value;
+            auto &top = stack[depth - 1];
+            if (top.is_object)
+                top.object.emplace_back(std::move(top.key), std::move(value));
+            else
+                top.array.push_back(std::move(value));
+
+            auto t = reader.read_token();
+            if (t == token::comma) {
+                if (top.is_object)
+                    read_key(reader, top.key);
+                break;
+            }
+            if (t != (top.is_object ? token::object_end : token::array_end)) {
+                reader.fail(ujson::error_code::invalid_syntax);
+                return ujson::value();
+            }
+            // move the contents into a container of their exact size, so
+            // the frame keeps its capacity for the next container
+            if (top.is_object) {
+                auto &members = top.object;
+                sort_members(members.begin(), members.end());
+                value = ujson::value(
+                    ujson::object(std::make_move_iterator(members.begin()),
+                                  std::make_move_iterator(members.end())),
+                    ujson::validate_utf8::no);
+                members.clear();
+            } else {
+                auto &elements = top.array;
+                value = ujson::value(
+                    ujson::array(std::make_move_iterator(elements.begin()),
+                                 std::make_move_iterator(elements.end())));
+                elements.clear();
+            }
+            --depth;
+        }
     }
-ujson46:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson47;
-    default:    goto ujson32;
+}
+
+// report value to handler; strings without escapes are passed straight
+// from the input, others from the reader's unescape buffer
+static void parse_events(ujson::reader &reader, ujson::handler &handler,
+                         const ujson::parse_options &opts) {
+
+    // consume the name and colon of an object member and report the name
+    auto key = [&] {
+        reader.expect(token::string);
+        handler.on_key(reader.read_string_view());
+        reader.expect(token::colon);
+    };
+
+    // whether each enclosing container is an object
+    std::vector<bool> stack;
+    for (;;) {
+        switch (reader.read_token()) {
+        case token::null:
+            handler.on_null();
+            break;
+        case token::true_value:
+            handler.on_bool(true);
+            break;
+        case token::false_value:
+            handler.on_bool(false);
+            break;
+        case token::number: {
+            std::int64_t i;
+            std::uint64_t u;
+            if (reader.read_int64(i))
+                handler.on_int64(i);
+            else if (reader.read_uint64(u))
+                handler.on_uint64(u);
+            else
+                handler.on_number(reader.read_double());
+            break;
+        }
+        case token::string:
+            handler.on_string(reader.read_string_view());
+            break;
+        case token::array_begin:
+            if (!check_depth(stack.size(), opts, reader))
+                return;
+            handler.on_start_array();
+            if (reader.peek_token() != token::array_end) {
+                stack.push_back(false);
+                continue;
+            }
+            reader.read_token();
+            handler.on_end_array();
+            break;
+        case token::object_begin:
+            if (!check_depth(stack.size(), opts, reader))
+                return;
+            handler.on_start_object();
+            if (reader.peek_token() != token::object_end) {
+                stack.push_back(true);
+                key();
+                continue;
+            }
+            reader.read_token();
+            handler.on_end_object();
+            break;
+        default:
+            reader.fail(ujson::error_code::invalid_syntax);
+            return;
+        }
+
+        // after a value: a comma or the end of the innermost container
+        for (;;) {
+            if (stack.empty())
+                return;
+            auto t = reader.read_token();
+            if (t == token::comma) {
+                if (stack.back())
+                    key();
+                break;
+            }
+            if (t != (stack.back() ? token::object_end : token::array_end)) {
+                reader.fail(ujson::error_code::invalid_syntax);
+                return;
+            }
+            if (stack.back())
+                handler.on_end_object();
+            else
+                handler.on_end_array();
+            stack.pop_back();
+        }
     }
-ujson47:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+}
+
+ujson::value ujson::reader::read_value() {
+    return parse_value(*this, parse_options());
+}
+
+// value of the raw number, as parse would have converted it
+ujson::value ujson::value::convert_raw_number(const value &v) {
+    auto text = raw_number_cast(v);
+    reader reader(text.data(), text.length());
+    reader.read_token();
+    std::int64_t i;
+    std::uint64_t u;
+    if (reader.read_int64(i))
+        return i;
+    if (reader.read_uint64(u))
+        return u;
+
+    // the text has no position in the input, so fail without a line
+    reader.record_errors();
+    auto d = reader.read_double();
+    if (reader.failed())
+        throw exception(error_code::bad_number);
+    return d;
+}
+
+ujson::value ujson::parse(const std::string &str) {
+    return parse(str.c_str(), str.size());
+}
+
+// parse a single value followed by eof
+static ujson::value parse_document(ujson::reader &reader,
+                                   const ujson::parse_options &opts,
+                                   char *insitu = nullptr) {
+
+    auto result = parse_value(reader, opts, insitu);
+
+    // fail if trailing junk is found
+    if (reader.read_token() != token::eof)
+        reader.fail(ujson::error_code::invalid_syntax);
+    return result;
+}
+
+ujson::value ujson::parse(const char *buffer, std::size_t len) {
+    return parse(buffer, len, parse_options());
+}
+
+ujson::value ujson::parse(const char *buffer, std::size_t len,
+                          const parse_options &opts) {
+    reader reader(buffer, len);
+    return parse_document(reader, opts);
+}
+
+ujson::value ujson::parse(const std::string &str, const parse_options &opts) {
+    return parse(str.c_str(), str.size(), opts);
+}
+
+ujson::value ujson::parse_prefix(const char *buffer, std::size_t len,
+                                 std::size_t &consumed) {
+    return parse_prefix(buffer, len, consumed, parse_options());
+}
+
+ujson::value ujson::parse_prefix(const char *buffer, std::size_t len,
+                                 std::size_t &consumed,
+                                 const parse_options &opts) {
+    reader reader(buffer, len);
+    auto result = parse_value(reader, opts);
+    consumed = reader.offset();
+    return result;
+}
+
+bool ujson::try_parse(const char *buffer, std::size_t len, value &result,
+                      parse_error &error) {
+    return try_parse(buffer, len, result, error, parse_options());
+}
+
+bool ujson::try_parse(const char *buffer, std::size_t len, value &result,
+                      parse_error &error, const parse_options &opts) {
+    reader reader(buffer, len);
+    reader.record_errors();
+    auto value = parse_document(reader, opts);
+    if (!reader.failed()) {
+        result = std::move(value);
+        return true;
     }
-ujson48:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson49;
-    default:    goto ujson32;
+    error.code = reader.error();
+    error.offset = reader.error_offset();
+
+    // the only pass over the lines before the error
+    auto line_first = buffer;
+    auto last = buffer + error.offset;
+    error.line = 1;
+    while (auto newline = static_cast<const char *>(std::memchr(
+               line_first, '\n',
+               static_cast<std::size_t>(last - line_first)))) {
+        ++error.line;
+        line_first = newline + 1;
     }
-ujson49:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+    error.column = static_cast<int>(last - line_first) + 1;
+    return false;
+}
+
+bool ujson::try_parse(const std::string &str, value &result,
+                      parse_error &error) {
+    return try_parse(str, result, error, parse_options());
+}
+
+bool ujson::try_parse(const std::string &str, value &result,
+                      parse_error &error, const parse_options &opts) {
+    return try_parse(str.c_str(), str.size(), result, error, opts);
+}
+
+ujson::value ujson::parse_padded(const char *buffer, std::size_t len) {
+    return parse_padded(buffer, len, parse_options());
+}
+
+ujson::value ujson::parse_padded(const char *buffer, std::size_t len,
+                                 const parse_options &opts) {
+    reader reader(buffer, len, padded::yes);
+    return parse_document(reader, opts);
+}
+
+ujson::value ujson::parse_padded(const padded_buffer &buffer) {
+    return parse_padded(buffer, parse_options());
+}
+
+ujson::value ujson::parse_padded(const padded_buffer &buffer,
+                                 const parse_options &opts) {
+    reader reader(buffer);
+    return parse_document(reader, opts);
+}
+
+ujson::value ujson::parse_insitu(char *buffer, std::size_t len) {
+    return parse_insitu(buffer, len, parse_options());
+}
+
+ujson::value ujson::parse_insitu(char *buffer, std::size_t len,
+                                 const parse_options &opts) {
+    reader reader(buffer, len);
+    return parse_document(reader, opts, buffer);
+}
+
+void ujson::parse(const std::string &str, handler &h) {
+    parse(str.c_str(), str.size(), h);
+}
+
+void ujson::parse(const char *buffer, std::size_t len, handler &h) {
+    parse(buffer, len, h, parse_options());
+}
+
+void ujson::parse(const char *buffer, std::size_t len, handler &h,
+                  const parse_options &opts) {
+
+    reader reader(buffer, len);
+    parse_events(reader, h, opts);
+
+    // fail if trailing junk is found
+    if (reader.read_token() != token::eof)
+        reader.fail(ujson::error_code::invalid_syntax);
+}
+
+//----------------------------------------------------------------------------
+// file parsing
+
+namespace {
+
+// read-only mapping of a whole file
+class file_mapping {
+public:
+    explicit file_mapping(const std::string &path);
+    ~file_mapping();
+
+    const char *data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+    // true if the rest of the last page, which reads as zeros, can serve as
+    // the padding of parse_padded
+    bool padded() const;
+
+private:
+    file_mapping(const file_mapping &);
+    file_mapping &operator=(const file_mapping &);
+
+    const char *m_data;
+    std::size_t m_size;
+    std::size_t m_page_size;
+};
+}
+
+#ifdef _WIN32
+
+file_mapping::file_mapping(const std::string &path)
+    : m_data(nullptr), m_size(0) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    m_page_size = info.dwPageSize;
+
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw ujson::exception(ujson::error_code::io_error);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) ||
+        static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        throw ujson::exception(ujson::error_code::io_error);
     }
-ujson50:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    // empty files cannot be mapped
+    if (m_size == 0) {
+        CloseHandle(file);
+        return;
     }
-ujson51:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+
+    // the view keeps the file and mapping open
+    auto mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        throw ujson::exception(ujson::error_code::io_error);
+    m_data = static_cast<const char *>(
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (!m_data)
+        throw ujson::exception(ujson::error_code::io_error);
+}
+
+file_mapping::~file_mapping() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+}
+
+#else
+
+file_mapping::file_mapping(const std::string &path)
+    : m_data(nullptr), m_size(0),
+      m_page_size(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw ujson::exception(ujson::error_code::io_error);
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+        static_cast<unsigned long long>(st.st_size) > SIZE_MAX) {
+        close(fd);
+        throw ujson::exception(ujson::error_code::io_error);
     }
-ujson52:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+    m_size = static_cast<std::size_t>(st.st_size);
+
+    // empty files cannot be mapped
+    if (m_size == 0) {
+        close(fd);
+        return;
     }
-ujson53:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 0x80:
-    case 0x81:
-    case 0x82:
-    case 0x83:
-    case 0x84:
-    case 0x85:
-    case 0x86:
-    case 0x87:
-    case 0x88:
-    case 0x89:
-    case 0x8A:
-    case 0x8B:
-    case 0x8C:
-    case 0x8D:
-    case 0x8E:
-    case 0x8F:
-    case 0x90:
-    case 0x91:
-    case 0x92:
-    case 0x93:
-    case 0x94:
-    case 0x95:
-    case 0x96:
-    case 0x97:
-    case 0x98:
-    case 0x99:
-    case 0x9A:
-    case 0x9B:
-    case 0x9C:
-    case 0x9D:
-    case 0x9E:
-    case 0x9F:
-    case 0xA0:
-    case 0xA1:
-    case 0xA2:
-    case 0xA3:
-    case 0xA4:
-    case 0xA5:
-    case 0xA6:
-    case 0xA7:
-    case 0xA8:
-    case 0xA9:
-    case 0xAA:
-    case 0xAB:
-    case 0xAC:
-    case 0xAD:
-    case 0xAE:
-    case 0xAF:
-    case 0xB0:
-    case 0xB1:
-    case 0xB2:
-    case 0xB3:
-    case 0xB4:
-    case 0xB5:
-    case 0xB6:
-    case 0xB7:
-    case 0xB8:
-    case 0xB9:
-    case 0xBA:
-    case 0xBB:
-    case 0xBC:
-    case 0xBD:
-    case 0xBE:
-    case 0xBF:    goto ujson30;
-    default:    goto ujson32;
+
+    // the mapping keeps the file open
+    auto ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+        throw ujson::exception(ujson::error_code::io_error);
+    m_data = static_cast<const char *>(ptr);
+
+    // the file is read once from start to end; huge pages, where the file
+    // system supports them, mean fewer page faults. Both are only hints
+    madvise(ptr, m_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, m_size, MADV_HUGEPAGE);
+#endif
+}
+
+file_mapping::~file_mapping() {
+    if (m_data)
+        munmap(const_cast<char *>(m_data), m_size);
+}
+
+#endif
+
+bool file_mapping::padded() const {
+    auto tail = m_size % m_page_size;
+    return tail != 0 &&
+           m_page_size - tail >= static_cast<std::size_t>(ujson::padding);
+}
+
+ujson::value ujson::parse_file(const std::string &path) {
+    return parse_file(path, parse_options());
+}
+
+ujson::value ujson::parse_file(const std::string &path,
+                               const parse_options &opts) {
+    file_mapping file(path);
+
+    // strings must not refer to the mapping
+    auto copy_opts = opts;
+    copy_opts.borrowed_strings = false;
+
+    // an empty file holds no value; it is not mapped, and a reader over zero
+    // bytes would take its buffer as zero terminated
+    if (file.size() == 0)
+        throw exception(error_code::invalid_syntax, 1);
+    reader reader(file.data(), file.size(),
+                  file.padded() ? padded::yes : padded::no);
+    return parse_document(reader, copy_opts);
+}
+
+//----------------------------------------------------------------------------
+// projection
+//
+// The paths form a tree of nodes. Members and elements that no node selects
+// are skipped by matching brackets and quotes, and once every name a node
+// lists has been found the rest of its object is skipped the same way.
+
+struct ujson::projection::node {
+    node() : whole(false), elements(0) {}
+
+    // the child selecting name, or nullptr
+    const node *find(const std::string &name) const {
+        auto it = children.find(name);
+        return it != children.end() ? it->second.get() : any.get();
     }
-ujson54:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'a':
-    case 'b':
-    case 'c':    goto ujson55;
-    case 'D':
-    case 'd':    goto ujson56;
-    case 'E':
-    case 'F':
-    case 'e':
-    case 'f':    goto ujson57;
-    default:    goto ujson32;
+
+    // add what other selects
+    void merge(const node &other) {
+        whole = whole || other.whole;
+        elements = std::max(elements, other.elements);
+        for (auto &child : other.children) {
+            auto &mine = children[child.first];
+            if (!mine)
+                mine.reset(new node);
+            mine->merge(*child.second);
+        }
+        if (other.any) {
+            if (!any)
+                any.reset(new node);
+            any->merge(*other.any);
+        }
     }
-ujson55:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson70;
-    default:    goto ujson32;
+
+    // let named children also select what the "*" child does, so each
+    // member or element is matched by a single node
+    void distribute() {
+        for (auto &child : children) {
+            if (any)
+                child.second->merge(*any);
+            child.second->distribute();
+        }
+        if (any)
+            any->distribute();
     }
-ujson56:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':    goto ujson61;
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'a':
-    case 'b':    goto ujson60;
-    default:    goto ujson32;
+
+    // whether the whole value is selected
+    bool whole;
+
+    std::map<std::string, std::unique_ptr<node>> children;
+
+    // child for "*" segments
+    std::unique_ptr<node> any;
+
+    // one past the largest array index among the children
+    std::size_t elements;
+};
+
+ujson::projection::projection(std::initializer_list<std::string> paths)
+    : m_root(new node) {
+    for (auto &path : paths)
+        add(path);
+    m_root->distribute();
+}
+
+ujson::projection::projection(const std::vector<std::string> &paths)
+    : m_root(new node) {
+    for (auto &path : paths)
+        add(path);
+    m_root->distribute();
+}
+
+ujson::projection::~projection() {}
+
+void ujson::projection::add(const std::string &path) {
+    if (!path.empty() && path[0] != '/')
+        throw std::invalid_argument("JSON pointer must start with '/'");
+
+    auto n = m_root.get();
+    std::size_t first = 1;
+    while (first <= path.size()) {
+        auto last = std::min(path.find('/', first), path.size());
+
+        // unescape ~1 to '/' and ~0 to '~'
+        std::string segment;
+        for (auto i = first; i < last; ++i) {
+            if (path[i] == '~' && i + 1 < last &&
+                (path[i + 1] == '0' || path[i + 1] == '1'))
+                segment += path[++i] == '0' ? '~' : '/';
+            else
+                segment += path[i];
+        }
+        first = last + 1;
+
+        auto &child = segment == "*" ? n->any : n->children[segment];
+        if (!child)
+            child.reset(new node);
+
+        // a segment of digits without leading zeros is also an index
+        if (!segment.empty() && segment.size() <= 9 &&
+            segment.find_first_not_of("0123456789") == std::string::npos &&
+            (segment[0] != '0' || segment.size() == 1))
+            n->elements = std::max<std::size_t>(
+                n->elements, std::stoul(segment) + 1);
+        n = child.get();
     }
-ujson57:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson58;
-    default:    goto ujson32;
+    n->whole = true;
+}
+
+bool ujson::projection::parse(reader &reader, const node &n,
+                              const parse_options &opts, std::size_t depth,
+                              value &result) const {
+    if (n.whole) {
+        auto remaining = opts;
+        remaining.max_depth -= depth;
+        result = parse_value(reader, remaining);
+        return true;
     }
-ujson58:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson59;
-    default:    goto ujson32;
+
+    auto t = reader.peek_token();
+    if (t != token::array_begin && t != token::object_begin) {
+        reader.skip_value_unchecked();
+        return false;
     }
-ujson59:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson30;
-    default:    goto ujson32;
+    if (!check_depth(depth, opts, reader))
+        return false;
+    reader.read_token();
+
+    if (t == token::object_begin) {
+        object members;
+        if (reader.peek_token() == token::object_end) {
+            reader.read_token();
+            result = value(std::move(members), validate_utf8::no);
+            return true;
+        }
+        std::string key;
+        std::vector<const node *> found;
+        for (;;) {
+            read_key(reader, key);
+            auto child = n.find(key);
+            value v;
+            if (!child)
+                reader.skip_value_unchecked();
+            else if (parse(reader, *child, opts, depth + 1, v))
+                members.emplace_back(key, std::move(v));
+
+            t = reader.read_token();
+            if (child && !n.any &&
+                std::find(found.begin(), found.end(), child) == found.end()) {
+                found.push_back(child);
+                if (found.size() == n.children.size() && t == token::comma) {
+                    reader.skip_unchecked(1);
+                    break;
+                }
+            }
+            if (t == token::object_end)
+                break;
+            if (t != token::comma) {
+                reader.fail(error_code::invalid_syntax);
+                return false;
+            }
+        }
+        sort_members(members.begin(), members.end());
+        result = value(std::move(members), validate_utf8::no);
+        return true;
     }
-ujson60:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson63;
-    default:    goto ujson32;
+
+    array elements;
+    if (reader.peek_token() != token::array_end) {
+        // elements not selected, pending a later one that is
+        std::size_t nulls = 0;
+        for (std::size_t i = 0;; ++i) {
+            if (!n.any && i == n.elements) {
+                // the first element has been peeked, so consume it and
+                // count its bracket if it opens an array or object
+                std::size_t open = 1;
+                if (i == 0) {
+                    t = reader.read_token();
+                    if (t == token::array_begin || t == token::object_begin)
+                        ++open;
+                }
+                reader.skip_unchecked(open);
+                break;
+            }
+            auto child = n.children.empty() ? n.any.get()
+                                            : n.find(std::to_string(i));
+            value v;
+            if (!child) {
+                reader.skip_value_unchecked();
+                ++nulls;
+            } else if (parse(reader, *child, opts, depth + 1, v)) {
+                elements.resize(elements.size() + nulls);
+                nulls = 0;
+                elements.push_back(std::move(v));
+            } else {
+                ++nulls;
+            }
+
+            t = reader.read_token();
+            if (t == token::array_end)
+                break;
+            if (t != token::comma) {
+                reader.fail(error_code::invalid_syntax);
+                return false;
+            }
+        }
+    } else {
+        reader.read_token();
     }
-ujson61:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson62;
-    default:    goto ujson32;
+    result = value(std::move(elements));
+    return true;
+}
+
+ujson::value ujson::parse_projected(const char *buffer, std::size_t len,
+                                    const projection &paths,
+                                    const parse_options &opts) {
+    reader reader(buffer, len);
+    value result;
+    paths.parse(reader, *paths.m_root, opts, 0, result);
+    if (reader.read_token() != token::eof)
+        reader.fail(error_code::invalid_syntax);
+    return result;
+}
+
+ujson::value ujson::parse_projected(const std::string &str,
+                                    const projection &paths,
+                                    const parse_options &opts) {
+    return parse_projected(str.c_str(), str.size(), paths, opts);
+}
+
+//----------------------------------------------------------------------------
+// document
+
+namespace {
+
+// bump allocator over a list of chunks, which are only freed together
+class arena {
+public:
+    arena() : m_next(nullptr), m_end(nullptr), m_capacity(0) {}
+
+    void *allocate(std::size_t size, std::size_t alignment) {
+        void *ptr = m_next;
+        auto space = static_cast<std::size_t>(m_end - m_next);
+        if (!std::align(alignment, size, ptr, space)) {
+            add_chunk(std::max(size + alignment, std::max<std::size_t>(
+                                                     m_capacity, 4096)));
+            ptr = m_next;
+        }
+        m_next = static_cast<char *>(ptr) + size;
+        return ptr;
     }
-ujson62:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson30;
-    default:    goto ujson32;
+
+    // free all allocations; the chunks are merged into one, so the next
+    // round of similar size needs no allocation
+    void reset() {
+        if (m_chunks.size() > 1) {
+            auto capacity = m_capacity;
+            m_chunks.clear();
+            m_capacity = 0;
+            add_chunk(capacity);
+        } else if (!m_chunks.empty()) {
+            m_next = m_chunks.front().get();
+        }
     }
-ujson63:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson64;
-    default:    goto ujson32;
+
+    std::size_t capacity() const { return m_capacity; }
+
+private:
+    void add_chunk(std::size_t size) {
+        m_chunks.emplace_back(new char[size]);
+        m_next = m_chunks.back().get();
+        m_end = m_next + size;
+        m_capacity += size;
     }
-ujson64:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '\\':    goto ujson65;
-    default:    goto ujson32;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    char *m_next;
+    char *m_end;
+    std::size_t m_capacity;
+};
+
+// standard allocator interface to an arena; deallocation is a no-op
+template <typename T> class arena_allocator {
+public:
+    typedef T value_type;
+
+    explicit arena_allocator(arena &a) : m_arena(&a) {}
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &rhs) : m_arena(rhs.m_arena) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
     }
-ujson65:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 'u':    goto ujson66;
-    default:    goto ujson32;
+
+    void deallocate(T *, std::size_t) {}
+
+    template <typename U> bool operator==(const arena_allocator<U> &rhs) const {
+        return m_arena == rhs.m_arena;
     }
-ujson66:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 'D':
-    case 'd':    goto ujson67;
-    default:    goto ujson32;
+
+    template <typename U> bool operator!=(const arena_allocator<U> &rhs) const {
+        return m_arena != rhs.m_arena;
     }
-ujson67:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson68;
-    default:    goto ujson32;
+
+private:
+    template <typename U> friend class arena_allocator;
+
+    arena *m_arena;
+};
+}
+
+struct ujson::document::impl {
+    // parse value; strings are copied to the arena unless borrowed
+    value parse_value(reader &reader, const parse_options &opts);
+
+    // consume the name and colon of an object member and add the member
+    void push_member(reader &reader);
+
+    // build the innermost open container from its elements or members
+    value close_container();
+
+    // zero terminated copy of str in the arena
+    value copy_string(string_view str);
+
+    arena memory;
+    value root;
+
+    // open arrays and objects, with the index of their first element or
+    // member below
+    struct container {
+        bool is_object;
+        std::size_t first;
+    };
+    std::vector<container> containers;
+
+    // elements and members of the arrays and objects being parsed; each is
+    // moved into storage of its final size once complete
+    std::vector<value> values;
+    std::vector<name_value_pair> members;
+};
+
+ujson::value ujson::document::impl::parse_value(reader &reader,
+                                                const parse_options &opts) {
+    for (;;) {
+        // parse a scalar, or open a container and continue with its first
+        // element
+        value element;
+        switch (reader.read_token()) {
+        case token::null:
+            break;
+        case token::true_value:
+            element = true;
+            break;
+        case token::false_value:
+            element = false;
+            break;
+        case token::number:
+            element = read_number(reader, opts);
+            break;
+        case token::string:
+            if (opts.borrowed_strings)
+                element = reader.read_borrowed_string();
+            else
+                element = copy_string(reader.read_string_view());
+            break;
+        case token::array_begin:
+            if (!check_depth(containers.size(), opts, reader))
+                return value();
+            containers.push_back(container{ false, values.size() });
+            if (reader.peek_token() != token::array_end)
+                continue;
+            reader.read_token();
+            element = close_container();
+            break;
+        case token::object_begin:
+            if (!check_depth(containers.size(), opts, reader))
+                return value();
+            containers.push_back(container{ true, members.size() });
+            if (reader.peek_token() != token::object_end) {
+                push_member(reader);
+                continue;
+            }
+            reader.read_token();
+            element = close_container();
+            break;
+        default:
+            reader.fail(error_code::invalid_syntax);
+            return value();
+        }
+
+        // add element to the innermost container, closing those that end
+        for (;;) {
+            if (containers.empty())
+                return element;
+            const bool is_object = containers.back().is_object;
+            if (is_object)
+                members.back().second = std::move(element);
+            else
+                values.push_back(std::move(element));
+
+            auto t = reader.read_token();
+            if (t == token::comma) {
+                if (is_object)
+                    push_member(reader);
+                break;
+            }
+            if (t != (is_object ? token::object_end : token::array_end)) {
+                reader.fail(error_code::invalid_syntax);
+                return value();
+            }
+            element = close_container();
+        }
     }
-ujson68:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson69;
-    default:    goto ujson32;
+}
+
+void ujson::document::impl::push_member(reader &reader) {
+    reader.expect(token::string);
+    auto key = reader.read_string_view();
+    members.emplace_back(std::string(key.data(), key.length()), null);
+    reader.expect(token::colon);
+}
+
+ujson::value ujson::document::impl::close_container() {
+    const auto top = containers.back();
+    containers.pop_back();
+    if (!top.is_object) {
+        auto ptr = std::allocate_shared<array>(
+            arena_allocator<array>(memory),
+            std::make_move_iterator(values.begin() + top.first),
+            std::make_move_iterator(values.end()));
+        values.erase(values.begin() + top.first, values.end());
+        return value::make_array(ptr);
     }
-ujson69:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson30;
-    default:    goto ujson32;
+    sort_members(members.begin() + top.first, members.end());
+    auto ptr = std::allocate_shared<object>(
+        arena_allocator<object>(memory),
+        std::make_move_iterator(members.begin() + top.first),
+        std::make_move_iterator(members.end()));
+    members.erase(members.begin() + top.first, members.end());
+    return value::make_object(ptr);
+}
+
+ujson::value ujson::document::impl::copy_string(string_view str) {
+    const auto len = str.length();
+    auto ptr = static_cast<char *>(memory.allocate(len + 1, 1));
+    std::memcpy(ptr, str.data(), len);
+    ptr[len] = 0;
+    return value::make_borrowed_string(ptr, len);
+}
+
+ujson::document::document() : m_impl(new impl) {}
+
+ujson::document::~document() {}
+
+const ujson::value &ujson::document::parse(const char *buffer,
+                                           std::size_t len) {
+    return parse(buffer, len, parse_options());
+}
+
+const ujson::value &ujson::document::parse(const char *buffer,
+                                           std::size_t len,
+                                           const parse_options &opts) {
+
+    // release the previous value before its memory is reused
+    auto &d = *m_impl;
+    d.root = null;
+    d.containers.clear();
+    d.values.clear();
+    d.members.clear();
+    d.memory.reset();
+
+    reader reader(buffer, len);
+    auto result = d.parse_value(reader, opts);
+
+    // fail if trailing junk is found
+    if (reader.read_token() != token::eof)
+        reader.fail(error_code::invalid_syntax);
+
+    d.root = std::move(result);
+    return d.root;
+}
+
+const ujson::value &ujson::document::parse(const std::string &str) {
+    return parse(str.c_str(), str.size());
+}
+
+const ujson::value &ujson::document::parse(const std::string &str,
+                                           const parse_options &opts) {
+    return parse(str.c_str(), str.size(), opts);
+}
+
+const ujson::value &ujson::document::root() const noexcept {
+    return m_impl->root;
+}
+
+std::size_t ujson::document::capacity() const noexcept {
+    return m_impl->memory.capacity();
+}
+
+//----------------------------------------------------------------------------
+// tape
+
+ujson::tape::tape() : m_name_count(0) {}
+
+ujson::element ujson::tape::parse(const char *buffer, std::size_t len) {
+    return parse(buffer, len, parse_options());
+}
+
+ujson::element ujson::tape::parse(const std::string &str) {
+    return parse(str.c_str(), str.size());
+}
+
+ujson::element ujson::tape::parse(const char *buffer, std::size_t len,
+                                  const parse_options &opts) {
+
+    m_words.clear();
+    m_strings.clear();
+    std::fill(m_names.begin(), m_names.end(),
+              std::pair<std::uint64_t, std::size_t>());
+    m_name_count = 0;
+
+    reader reader(buffer, len);
+    try {
+        append(reader, opts);
+
+        // fail if trailing junk is found
+        if (reader.read_token() != token::eof)
+            reader.fail(error_code::invalid_syntax);
+    } catch (...) {
+        m_words.clear();
+        m_strings.clear();
+        throw;
+    }
+    return root();
+}
+
+ujson::element ujson::tape::root() const noexcept {
+    static const std::uint64_t null_word = element::null_tag;
+    if (m_words.empty())
+        return element(&null_word, m_strings.c_str());
+    return element(m_words.data(), m_strings.c_str());
+}
+
+std::size_t ujson::tape::size() const noexcept { return m_words.size(); }
+
+void ujson::tape::append(reader &reader, const parse_options &opts) {
+
+    // open arrays and objects: their header word and element count
+    struct container {
+        bool is_object;
+        std::size_t first;
+        std::uint64_t count;
+    };
+    std::vector<container> stack;
+
+    // header words are filled in once the size is known
+    auto close = [&] {
+        auto const &top = stack.back();
+        auto tag = top.is_object ? element::object_tag : element::array_tag;
+        m_words[top.first] = std::uint64_t(tag) << element::tag_shift |
+                             (m_words.size() - top.first);
+        m_words[top.first + 1] = top.count;
+        stack.pop_back();
+    };
+    // names are interned, so repeated ones share their string contents
+    auto key = [&] {
+        reader.expect(token::string);
+        auto name = reader.read_string_view();
+        m_words.push_back(std::uint64_t(element::string_tag)
+                              << element::tag_shift |
+                          intern(name));
+        m_words.push_back(name.length());
+        reader.expect(token::colon);
+    };
+
+    const auto shift = element::tag_shift;
+    for (;;) {
+        // append a scalar, or open a container and continue with its first
+        // element
+        switch (reader.read_token()) {
+        case token::null:
+            m_words.push_back(std::uint64_t(element::null_tag) << shift);
+            break;
+        case token::true_value:
+            m_words.push_back(std::uint64_t(element::true_tag) << shift);
+            break;
+        case token::false_value:
+            m_words.push_back(std::uint64_t(element::false_tag) << shift);
+            break;
+        case token::number: {
+            std::int64_t i;
+            std::uint64_t u;
+            if (reader.read_int64(i)) {
+                m_words.push_back(std::uint64_t(element::int64_tag) << shift);
+                m_words.push_back(std::uint64_t(i));
+            } else if (reader.read_uint64(u)) {
+                m_words.push_back(std::uint64_t(element::uint64_tag)
+                                  << shift);
+                m_words.push_back(u);
+            } else {
+                auto d = reader.read_double();
+                m_words.push_back(std::uint64_t(element::double_tag)
+                                  << shift);
+                m_words.push_back(0);
+                std::memcpy(&m_words.back(), &d, sizeof(d));
+            }
+            break;
+        }
+        case token::string:
+            append_string(element::string_tag, reader.read_string_view());
+            break;
+        case token::array_begin:
+            if (!check_depth(stack.size(), opts, reader))
+                return;
+            stack.push_back(container{ false, m_words.size(), 0 });
+            m_words.resize(m_words.size() + 2);
+            if (reader.peek_token() != token::array_end)
+                continue;
+            reader.read_token();
+            close();
+            break;
+        case token::object_begin:
+            if (!check_depth(stack.size(), opts, reader))
+                return;
+            stack.push_back(container{ true, m_words.size(), 0 });
+            m_words.resize(m_words.size() + 2);
+            if (reader.peek_token() != token::object_end) {
+                key();
+                continue;
+            }
+            reader.read_token();
+            close();
+            break;
+        default:
+            reader.fail(error_code::invalid_syntax);
+            return;
+        }
+
+        // count the value in the innermost container, closing those that
+        // end
+        for (;;) {
+            if (stack.empty())
+                return;
+            auto &top = stack.back();
+            ++top.count;
+
+            auto t = reader.read_token();
+            if (t == token::comma) {
+                if (top.is_object)
+                    key();
+                break;
+            }
+            if (t != (top.is_object ? token::object_end : token::array_end)) {
+                reader.fail(error_code::invalid_syntax);
+                return;
+            }
+            close();
+        }
+    }
+}
+
+void ujson::tape::append_string(std::uint64_t tag, string_view str) {
+    m_words.push_back(tag << element::tag_shift | m_strings.size());
+    m_words.push_back(str.length());
+    m_strings.append(str.data(), str.length());
+    m_strings.push_back(0);
+}
+
+// FNV-1a
+static std::size_t hash_name(const char *name, std::size_t len) {
+    std::uint64_t hash = 14695981039346656037u;
+    for (std::size_t i = 0; i < len; ++i)
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211u;
+    return static_cast<std::size_t>(hash);
+}
+
+std::uint64_t ujson::tape::intern(string_view name) {
+    const auto len = name.length();
+    if (2 * (m_name_count + 1) > m_names.size()) {
+        std::vector<std::pair<std::uint64_t, std::size_t>> names(
+            std::max<std::size_t>(64, 2 * m_names.size()));
+        for (auto const &slot : m_names) {
+            if (!slot.first)
+                continue;
+            auto i = hash_name(m_strings.data() + slot.first - 1,
+                               slot.second);
+            while (names[i & (names.size() - 1)].first)
+                ++i;
+            names[i & (names.size() - 1)] = slot;
+        }
+        m_names.swap(names);
+    }
+
+    const auto mask = m_names.size() - 1;
+    for (auto i = hash_name(name.data(), len);; ++i) {
+        auto &slot = m_names[i & mask];
+        if (!slot.first) {
+            slot = { m_strings.size() + 1, len };
+            ++m_name_count;
+            m_strings.append(name.data(), len);
+            m_strings.push_back(0);
+            return slot.first - 1;
+        }
+        if (slot.second == len &&
+            std::memcmp(m_strings.data() + slot.first - 1, name.data(),
+                        len) == 0)
+            return slot.first - 1;
+    }
+}
+
+ujson::value ujson::to_value(element e) {
+    // open arrays and objects with their children still to convert; an
+    // explicit stack, so deep tapes do not use more thread stack
+    struct array_frame {
+        array_view::iterator next, end;
+        array elements;
+    };
+    struct object_frame {
+        object_view::iterator next, end;
+        object members;
+    };
+    std::vector<array_frame> arrays;
+    std::vector<object_frame> objects;
+    std::vector<bool> is_object;
+
+    for (;;) {
+        // convert a scalar, or open a container and continue with its first
+        // child
+        value v;
+        bool complete = false;
+        switch (e.type()) {
+        case value_type::null:
+            complete = true;
+            break;
+        case value_type::boolean:
+            v = bool_cast(e);
+            complete = true;
+            break;
+        case value_type::number:
+            v = e.number();
+            complete = true;
+            break;
+        case value_type::string: {
+            auto str = string_cast(e);
+            v = value(str.data(), str.length(), validate_utf8::no);
+            complete = true;
+            break;
+        }
+        case value_type::array: {
+            auto view = array_cast(e);
+            arrays.push_back(array_frame{ view.begin(), view.end(), array() });
+            arrays.back().elements.reserve(view.size());
+            is_object.push_back(false);
+            break;
+        }
+        default: {
+            auto view = object_cast(e);
+            objects.push_back(
+                object_frame{ view.begin(), view.end(), object() });
+            objects.back().members.reserve(view.size());
+            is_object.push_back(true);
+            break;
+        }
+        }
+
+        // add v to the innermost container, then continue with its next
+        // child, or close it if there is none
+        for (;;) {
+            if (is_object.empty())
+                return v;
+            if (is_object.back()) {
+                auto &top = objects.back();
+                if (complete)
+                    top.members.back().second = std::move(v);
+                if (top.next != top.end) {
+                    auto member = *top.next;
+                    ++top.next;
+                    top.members.emplace_back(member.first, null);
+                    e = member.second;
+                    break;
+                }
+                v = value(std::move(top.members), validate_utf8::no);
+                objects.pop_back();
+            } else {
+                auto &top = arrays.back();
+                if (complete)
+                    top.elements.push_back(std::move(v));
+                if (top.next != top.end) {
+                    e = *top.next;
+                    ++top.next;
+                    break;
+                }
+                v = value(std::move(top.elements));
+                arrays.pop_back();
+            }
+            is_object.pop_back();
+            complete = true;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// value stream
+
+ujson::value_stream::value_stream(const char *buffer, std::size_t len,
+                                  skip_invalid skip,
+                                  const parse_options &opts)
+    : m_buffer(buffer), m_length(len ? len : std::strlen(buffer)),
+      m_skip(skip), m_opts(opts), m_base(0), m_lines(0),
+      m_reader(buffer, m_length), m_offset(0), m_skipped(0) {}
+
+bool ujson::value_stream::next(value &v) {
+    for (;;) {
+        // an empty rest of the buffer would be taken as zero terminated
+        if (m_base == m_length)
+            return false;
+
+        bool started = false;
+        try {
+            // a zero byte also reads as eof, so check it is at the end
+            if (m_reader.peek_token() == token::eof) {
+                if (m_reader.token_offset() == m_length - m_base)
+                    return false;
+                m_reader.fail(error_code::invalid_syntax);
+            }
+            m_offset = m_base + m_reader.token_offset();
+            started = true;
+            v = parse_value(m_reader, m_opts);
+            return true;
+        } catch (exception const &e) {
+            if (!started)
+                m_offset = m_base + m_reader.token_offset();
+            auto lines = m_lines;
+            skip_line();
+            if (m_skip == skip_invalid::no) {
+                if (e.get_line() == -1)
+                    throw;
+                throw exception(e.get_error_code(), lines + e.get_line());
+            }
+            ++m_skipped;
+        }
+    }
+}
+
+void ujson::value_stream::skip_line() {
+    auto first = m_buffer + m_offset;
+    auto limit = m_buffer + m_length;
+    auto newline = static_cast<const char *>(
+        std::memchr(first, '\n', static_cast<std::size_t>(limit - first)));
+    auto next = newline ? newline + 1 : limit;
+    m_lines += static_cast<int>(std::count(m_buffer + m_base, next, '\n'));
+    m_base = static_cast<std::size_t>(next - m_buffer);
+    if (m_base != m_length)
+        m_reader = reader(next, m_length - m_base);
+}
+
+std::size_t ujson::value_stream::offset() const noexcept { return m_offset; }
+
+std::size_t ujson::value_stream::skipped() const noexcept {
+    return m_skipped;
+}
+
+ujson::value_stream ujson::parse_many(const char *buffer, std::size_t len,
+                                      skip_invalid skip,
+                                      const parse_options &opts) {
+    return value_stream(buffer, len, skip, opts);
+}
+
+//----------------------------------------------------------------------------
+// parallel value stream
+//
+// Workers take the next chunk of the buffer, ending after the first line feed
+// past chunk_size, parse it with a value_stream and hand the results to the
+// reader. A worker waits while max_chunks chunks are taken but not yet read.
+
+struct ujson::parallel_value_stream::impl {
+    impl(const char *buffer, std::size_t len, skip_invalid skip,
+         const parse_options &opts, const parallel_options &parallel);
+
+    // worker thread
+    void work();
+
+    // parse the values of [first, last)
+    struct chunk;
+    std::unique_ptr<chunk> parse_chunk(std::size_t first, std::size_t last);
+
+    // a value, or the exception thrown in its place
+    struct result {
+        std::size_t offset;
+        value v;
+        std::exception_ptr error;
+    };
+    struct chunk {
+        std::vector<result> results;
+        std::size_t skipped;
+    };
+
+    const char *buffer;
+    std::size_t length;
+    skip_invalid skip;
+    parse_options opts;
+    bool ordered;
+    std::size_t chunk_size;
+    std::size_t max_chunks;
+
+    std::mutex mutex;
+    std::condition_variable can_take;   // for workers
+    std::condition_variable chunk_done; // for the reader
+    bool stop;
+    std::size_t split;    // start of the next chunk to take
+    std::size_t taken;    // number of chunks taken
+    std::size_t read;     // number of chunks handed to the reader
+    std::size_t in_flight;
+    std::map<std::size_t, std::unique_ptr<chunk>> done; // by number
+
+    // chunk being read, owned by the reader
+    std::unique_ptr<chunk> current;
+    std::size_t index;
+    std::size_t offset;
+    std::size_t skipped;
+
+    std::vector<std::thread> threads;
+};
+
+ujson::parallel_value_stream::impl::impl(const char *buffer, std::size_t len,
+                                         skip_invalid skip,
+                                         const parse_options &opts,
+                                         const parallel_options &parallel)
+    : buffer(buffer), length(len ? len : std::strlen(buffer)), skip(skip),
+      opts(opts), ordered(parallel.ordered),
+      chunk_size(std::max<std::size_t>(parallel.chunk_size, 1)), stop(false),
+      split(0), taken(0), read(0), in_flight(0), index(0), offset(0),
+      skipped(0) {
+
+    auto count = parallel.threads ? parallel.threads
+                                  : std::thread::hardware_concurrency();
+    count = std::max(count, 1u);
+    max_chunks = parallel.max_chunks ? parallel.max_chunks : 2 * count;
+    try {
+        for (unsigned i = 0; i < count; ++i)
+            threads.emplace_back(&impl::work, this);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        can_take.notify_all();
+        for (auto &thread : threads)
+            thread.join();
+        throw;
     }
-ujson70:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson71;
-    default:    goto ujson32;
+}
+
+void ujson::parallel_value_stream::impl::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        can_take.wait(lock, [this] {
+            return stop || split == length || in_flight < max_chunks;
+        });
+        if (stop || split == length)
+            return;
+
+        auto first = split;
+        auto last = length;
+        if (length - first > chunk_size) {
+            auto limit = buffer + first + chunk_size;
+            auto newline = static_cast<const char *>(std::memchr(
+                limit, '\n', static_cast<std::size_t>(buffer + length - limit)));
+            if (newline)
+                last = static_cast<std::size_t>(newline + 1 - buffer);
+        }
+        split = last;
+        auto number = taken++;
+        ++in_flight;
+        if (split == length)
+            can_take.notify_all(); // let idle workers exit
+
+        lock.unlock();
+        auto c = parse_chunk(first, last);
+        lock.lock();
+
+        done[number] = std::move(c);
+        chunk_done.notify_one();
     }
-ujson71:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 'A':
-    case 'B':
-    case 'C':
-    case 'D':
-    case 'E':
-    case 'F':
-    case 'a':
-    case 'b':
-    case 'c':
-    case 'd':
-    case 'e':
-    case 'f':    goto ujson30;
-    default:    goto ujson32;
+}
+
+std::unique_ptr<ujson::parallel_value_stream::impl::chunk>
+ujson::parallel_value_stream::impl::parse_chunk(std::size_t first,
+                                                std::size_t last) {
+    std::unique_ptr<chunk> c(new chunk);
+    value_stream stream(buffer + first, last - first, skip, opts);
+    value v;
+    for (;;) {
+        try {
+            if (!stream.next(v))
+                break;
+            c->results.push_back(
+                result{ first + stream.offset(), std::move(v), nullptr });
+        } catch (exception const &e) {
+            // lines are counted from the start of the whole buffer
+            auto error = std::current_exception();
+            if (e.get_line() != -1) {
+                auto lines = std::count(buffer, buffer + first, '\n');
+                error = std::make_exception_ptr(exception(
+                    e.get_error_code(), static_cast<int>(lines) + e.get_line()));
+            }
+            c->results.push_back(result{ first + stream.offset(), null, error });
+        } catch (...) {
+            c->results.push_back(result{ first + stream.offset(), null,
+                                         std::current_exception() });
+            break;
+        }
     }
-ujson72:
-    yyaccept = 1;
-    marker = ++m_cursor;
-    yych = *m_cursor;
-ujson73:
-    switch (yych) {
-    case '.':    goto ujson74;
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson72;
-    case 'E':
-    case 'e':    goto ujson75;
-    default:    goto ujson20;
-    }
-ujson74:
-    yych = *++m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson79;
-    default:    goto ujson32;
+    c->skipped = stream.skipped();
+    return c;
+}
+
+ujson::parallel_value_stream::parallel_value_stream(
+    const char *buffer, std::size_t len, skip_invalid skip,
+    const parse_options &opts, const parallel_options &parallel)
+    : m_impl(new impl(buffer, len, skip, opts, parallel)) {}
+
+ujson::parallel_value_stream::~parallel_value_stream() {
+    auto &d = *m_impl;
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        d.stop = true;
     }
-ujson75:
-    yych = *++m_cursor;
-    switch (yych) {
-    case '+':
-    case '-':    goto ujson76;
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson77;
-    default:    goto ujson32;
+    d.can_take.notify_all();
+    for (auto &thread : d.threads)
+        thread.join();
+}
+
+bool ujson::parallel_value_stream::next(value &v) {
+    auto &d = *m_impl;
+    for (;;) {
+        if (d.current && d.index < d.current->results.size()) {
+            auto &r = d.current->results[d.index++];
+            d.offset = r.offset;
+            if (r.error)
+                std::rethrow_exception(r.error);
+            v = std::move(r.v);
+            return true;
+        }
+
+        // the finished chunk is freed after the lock is released
+        auto finished = std::move(d.current);
+        std::unique_lock<std::mutex> lock(d.mutex);
+        if (finished) {
+            --d.in_flight;
+            d.can_take.notify_one();
+        }
+
+        auto ready = [&d] {
+            return !d.done.empty() &&
+                   (!d.ordered || d.done.begin()->first == d.read);
+        };
+        d.chunk_done.wait(lock, [&] {
+            return ready() || (d.split == d.length && d.read == d.taken);
+        });
+        if (!ready())
+            return false;
+
+        d.current = std::move(d.done.begin()->second);
+        d.done.erase(d.done.begin());
+        ++d.read;
+        d.index = 0;
+        d.skipped += d.current->skipped;
     }
-ujson76:
-    yych = *++m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson77;
-    default:    goto ujson32;
+}
+
+std::size_t ujson::parallel_value_stream::offset() const noexcept {
+    return m_impl->offset;
+}
+
+std::size_t ujson::parallel_value_stream::skipped() const noexcept {
+    return m_impl->skipped;
+}
+
+//----------------------------------------------------------------------------
+// parallel parse
+//
+// The bytes between the brackets of the top-level array or object are cut
+// into pieces, which are indexed in two parallel passes. The first counts the
+// unescaped quotes of each piece, which tells whether the next one starts in
+// a string. The second finds the commas at the lowest nesting of each piece;
+// once the nesting at the start of each piece is known, those at the top
+// level separate the members. Runs of members are then parsed on their own
+// threads and joined. Every run is parsed strictly, so a wrong split caused
+// by invalid input only makes the run fail.
+
+namespace {
+
+// commas at the lowest nesting of a piece, relative to its start
+struct piece {
+    bool odd_quotes;
+    std::ptrdiff_t depth;
+    std::ptrdiff_t min_depth;
+    std::vector<const char *> commas;
+};
+}
+
+// run task(0) .. task(n - 1) on up to count threads, including the calling
+// one, and rethrow the exception of the first task that failed; if threads
+// cannot be started the ones already running do the work
+template <typename function>
+static void run_parallel(std::size_t n, unsigned count,
+                         const function &task) {
+    std::atomic<std::size_t> next(0);
+    std::vector<std::exception_ptr> errors(n);
+    auto work = [&] {
+        for (std::size_t i; (i = next++) < n;) {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    try {
+        for (unsigned i = 1; i < count && i < n; ++i)
+            threads.emplace_back(work);
+    } catch (std::system_error const &) {
     }
-ujson77:
-    ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson77;
-    default:    goto ujson20;
-    }
-ujson79:
-    yyaccept = 1;
-    marker = ++m_cursor;
-    yych = *m_cursor;
-    switch (yych) {
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':    goto ujson79;
-    case 'E':
-    case 'e':    goto ujson75;
-    default:    goto ujson20;
-    }
-ujson81:
-    yyaccept = 1;
-    yych = *(marker = ++m_cursor);
-    switch (yych) {
-    case '.':    goto ujson74;
-    case 'E':
-    case 'e':    goto ujson75;
-    default:    goto ujson20;
+    work();
+    for (auto &thread : threads)
+        thread.join();
+
+    for (auto &error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+// true if ptr follows an odd number of backslashes, counted back to first
+static bool is_escaped(const char *first, const char *ptr) {
+    auto run = ptr;
+    while (run != first && run[-1] == '\\')
+        --run;
+    return (ptr - run) % 2 != 0;
+}
+
+// index [first, last), which starts in a string if in_string is set; base is
+// the start of all pieces
+static void index_piece(const char *base, const char *first,
+                        const char *last, bool in_string, piece &p) {
+    std::ptrdiff_t depth = 0;
+    p.min_depth = 0;
+    for (auto ptr = first; ptr != last;) {
+        if (in_string) {
+            auto quote = static_cast<const char *>(std::memchr(
+                ptr, '"', static_cast<std::size_t>(last - ptr)));
+            if (!quote)
+                break;
+            ptr = quote + 1;
+            in_string = is_escaped(base, quote);
+            continue;
+        }
+        switch (*ptr) {
+        case '"':
+            in_string = true;
+            break;
+        case '[':
+        case '{':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (--depth < p.min_depth) {
+                p.min_depth = depth;
+                p.commas.clear();
+            }
+            break;
+        case ',':
+            if (depth == p.min_depth)
+                p.commas.push_back(ptr);
+            break;
+        }
+        ++ptr;
     }
-ujson82:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'l':    goto ujson83;
-    default:    goto ujson32;
+    p.depth = depth;
+}
+
+// whether [first, last) has an odd number of unescaped quotes
+static bool odd_quotes(const char *base, const char *first,
+                       const char *last) {
+    bool odd = false;
+    for (auto ptr = first;; ++ptr) {
+        ptr = static_cast<const char *>(
+            std::memchr(ptr, '"', static_cast<std::size_t>(last - ptr)));
+        if (!ptr)
+            return odd;
+        if (!is_escaped(base, ptr))
+            odd = !odd;
     }
-ujson83:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 's':    goto ujson84;
-    default:    goto ujson32;
+}
+
+static bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// parse the members in [first, last), which are separated by commas
+static void parse_members(const char *first, const char *last,
+                          bool is_object, const ujson::parse_options &opts,
+                          ujson::array &array, ujson::object &object) {
+    // a zero length reader would take the buffer as zero terminated
+    if (first == last)
+        throw ujson::exception(ujson::error_code::invalid_syntax, -1);
+
+    auto len = static_cast<std::size_t>(last - first);
+    ujson::reader reader(first, len);
+    std::string key;
+    for (;;) {
+        if (is_object) {
+            read_key(reader, key);
+            object.emplace_back(std::move(key), parse_value(reader, opts));
+        } else {
+            array.push_back(parse_value(reader, opts));
+        }
+
+        // a zero byte also reads as eof, so check it is at the end
+        auto t = reader.read_token();
+        if (t == token::eof && reader.token_offset() == len)
+            return;
+        if (t != token::comma) {
+            reader.fail(ujson::error_code::invalid_syntax);
+            return;
+        }
     }
-ujson84:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'e':    goto ujson85;
-    default:    goto ujson32;
+}
+
+ujson::value ujson::parse_parallel(const char *buffer, std::size_t len,
+                                   const parse_options &opts,
+                                   const parallel_options &parallel) {
+    if (!len)
+        len = std::strlen(buffer);
+
+    auto count = parallel.threads ? parallel.threads
+                                  : std::thread::hardware_concurrency();
+    auto chunk_size = std::max<std::size_t>(parallel.chunk_size, 1);
+    if (count <= 1 || len / 2 < chunk_size || opts.max_depth == 0)
+        return parse(buffer, len, opts);
+
+    // find the brackets of the top-level array or object
+    auto open = buffer;
+    auto close = buffer + len - 1;
+    while (open != close && is_whitespace(*open))
+        ++open;
+    while (close != open && is_whitespace(*close))
+        --close;
+    const bool is_object = *open == '{';
+    if (close - open < 2 || !(is_object || *open == '[') ||
+        *close != (is_object ? '}' : ']'))
+        return parse(buffer, len, opts);
+
+    try {
+        // index the pieces
+        auto first = open + 1;
+        auto inner = static_cast<std::size_t>(close - first);
+        auto n = (inner + chunk_size - 1) / chunk_size;
+        std::vector<piece> pieces(n);
+        auto piece_first = [&](std::size_t i) {
+            return first + std::min(i * chunk_size, inner);
+        };
+        run_parallel(n, count, [&](std::size_t i) {
+            pieces[i].odd_quotes =
+                odd_quotes(first, piece_first(i), piece_first(i + 1));
+        });
+        std::vector<bool> in_string(n);
+        for (std::size_t i = 1; i < n; ++i)
+            in_string[i] = in_string[i - 1] != pieces[i - 1].odd_quotes;
+        run_parallel(n, count, [&](std::size_t i) {
+            index_piece(first, piece_first(i), piece_first(i + 1),
+                        in_string[i], pieces[i]);
+        });
+
+        // split the members into runs of about chunk_size bytes at top-level
+        // commas
+        std::vector<std::pair<const char *, const char *>> runs;
+        auto run_first = first;
+        std::ptrdiff_t depth = 0;
+        for (auto &p : pieces) {
+            if (depth + p.min_depth < 0)
+                throw exception(error_code::invalid_syntax, -1);
+            if (depth + p.min_depth == 0) {
+                for (auto comma : p.commas) {
+                    if (static_cast<std::size_t>(comma - run_first) <
+                        chunk_size)
+                        continue;
+                    runs.emplace_back(run_first, comma);
+                    run_first = comma + 1;
+                }
+            }
+            depth += p.depth;
+            std::vector<const char *>().swap(p.commas);
+        }
+        if (depth != 0)
+            throw exception(error_code::invalid_syntax, -1);
+        runs.emplace_back(run_first, close);
+
+        // members are in the top-level container
+        auto member_opts = opts;
+        --member_opts.max_depth;
+        std::vector<array> arrays(runs.size());
+        std::vector<object> objects(runs.size());
+        run_parallel(runs.size(), count, [&](std::size_t i) {
+            parse_members(runs[i].first, runs[i].second, is_object,
+                          member_opts, arrays[i], objects[i]);
+        });
+
+        if (is_object) {
+            object result;
+            result.reserve(std::accumulate(
+                objects.begin(), objects.end(), std::size_t(0),
+                [](std::size_t n, object const &o) { return n + o.size(); }));
+            for (auto &o : objects)
+                std::move(o.begin(), o.end(), std::back_inserter(result));
+            return value(std::move(result), validate_utf8::no);
+        }
+        array result;
+        result.reserve(std::accumulate(
+            arrays.begin(), arrays.end(), std::size_t(0),
+            [](std::size_t n, array const &a) { return n + a.size(); }));
+        for (auto &a : arrays)
+            std::move(a.begin(), a.end(), std::back_inserter(result));
+        return value(std::move(result));
+    } catch (exception const &) {
+        // report the error, with its line, as parse does
+        return parse(buffer, len, opts);
     }
-ujson85:
-    ++m_cursor;
-    { return ujson_false; }
-ujson87:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'u':    goto ujson88;
-    default:    goto ujson32;
+}
+
+//----------------------------------------------------------------------------
+// incremental parser
+
+namespace {
+
+// builds a value from a stream of tokens using an explicit stack, so that
+// parsing can be suspended between any two tokens
+class value_builder {
+public:
+    explicit value_builder(const ujson::parse_options &opts);
+
+    // consume token t, which reader has just read
+    void push(token t, ujson::reader &reader);
+
+    // true once a complete value has been built
+    bool done() const;
+
+    // the complete value; resets the builder
+    ujson::value take();
+
+    // move elements of the top level array to elements instead of
+    // collecting them; the top level value must be an array
+    void stream_elements(std::deque<ujson::value> *elements);
+
+private:
+    enum class state {
+        value,
+        value_or_end,
+        key,
+        key_or_end,
+        colon,
+        comma_or_end,
+        done
+    };
+
+    void add(ujson::value value);
+
+    // open containers; at most parse_options::max_depth
+    std::vector<frame> m_stack;
+    ujson::parse_options m_opts;
+    state m_state;
+    ujson::value m_result;
+    std::deque<ujson::value> *m_elements;
+};
+}
+
+value_builder::value_builder(const ujson::parse_options &opts)
+    : m_opts(opts), m_state(state::value), m_elements(nullptr) {}
+
+bool value_builder::done() const { return m_state == state::done; }
+
+ujson::value value_builder::take() {
+    assert(done());
+    m_state = state::value;
+    return std::move(m_result);
+}
+
+void value_builder::stream_elements(std::deque<ujson::value> *elements) {
+    m_elements = elements;
+}
+
+void value_builder::add(ujson::value value) {
+    if (m_stack.empty()) {
+        m_result = std::move(value);
+        m_state = state::done;
+        return;
     }
-ujson88:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'e':    goto ujson89;
-    default:    goto ujson32;
+
+    if (m_elements && m_stack.size() == 1) {
+        m_elements->push_back(std::move(value));
+        m_state = state::comma_or_end;
+        return;
     }
-ujson89:
-    ++m_cursor;
-    { return ujson_true; }
-ujson91:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'l':    goto ujson92;
-    default:    goto ujson32;
+
+    auto &top = m_stack.back();
+    if (top.is_object)
+        top.object.emplace_back(std::move(top.key), std::move(value));
+    else
+        top.array.push_back(std::move(value));
+    m_state = state::comma_or_end;
+}
+
+void value_builder::push(token t, ujson::reader &reader) {
+    switch (m_state) {
+    case state::value_or_end:
+        if (t == token::array_end)
+            break;
+        // fall through
+    case state::value:
+        if (m_elements && m_stack.empty() && t != token::array_begin)
+            throw ujson::exception(ujson::error_code::invalid_syntax,
+                                   reader.line());
+        switch (t) {
+        case token::null:
+            add(ujson::null);
+            return;
+        case token::true_value:
+            add(true);
+            return;
+        case token::false_value:
+            add(false);
+            return;
+        case token::number:
+            add(read_number(reader, m_opts));
+            return;
+        case token::string:
+            add(ujson::value(reader.read_string(), ujson::validate_utf8::no));
+            return;
+        case token::array_begin:
+            if (m_stack.size() >= m_opts.max_depth)
+                throw ujson::exception(ujson::error_code::too_deep,
+                                       reader.line());
+            m_stack.emplace_back(false);
+            m_state = state::value_or_end;
+            return;
+        case token::object_begin:
+            if (m_stack.size() >= m_opts.max_depth)
+                throw ujson::exception(ujson::error_code::too_deep,
+                                       reader.line());
+            m_stack.emplace_back(true);
+            m_state = state::key_or_end;
+            return;
+        default:
+            throw ujson::exception(ujson::error_code::invalid_syntax,
+                                   reader.line());
+        }
+    case state::key_or_end:
+        if (t == token::object_end)
+            break;
+        // fall through
+    case state::key:
+        if (t != token::string)
+            throw ujson::exception(ujson::error_code::invalid_syntax,
+                                   reader.line());
+        reader.read_string(m_stack.back().key);
+        m_state = state::colon;
+        return;
+    case state::colon:
+        if (t != token::colon)
+            throw ujson::exception(ujson::error_code::invalid_syntax,
+                                   reader.line());
+        m_state = state::value;
+        return;
+    case state::comma_or_end:
+        if (t == token::comma) {
+            m_state = m_stack.back().is_object ? state::key : state::value;
+            return;
+        }
+        if (t == (m_stack.back().is_object ? token::object_end
+                                           : token::array_end))
+            break;
+        throw ujson::exception(ujson::error_code::invalid_syntax,
+                               reader.line());
+    case state::done:
+        throw ujson::exception(ujson::error_code::invalid_syntax,
+                               reader.line());
     }
-ujson92:
-    yych = *++m_cursor;
-    switch (yych) {
-    case 'l':    goto ujson93;
-    default:    goto ujson32;
+
+    // t closes the innermost array or object
+    auto top = std::move(m_stack.back());
+    m_stack.pop_back();
+    if (top.is_object)
+        add(ujson::value(std::move(top.object), ujson::validate_utf8::no));
+    else
+        add(ujson::value(std::move(top.array)));
+}
+
+// find the end of a token of the kind given by its first character, which
+// has already been consumed; escaped tracks a pending backslash in strings
+// returns nullptr if the token extends to limit and may be incomplete
+static const char *token_end(char kind, bool &escaped, const char *ptr,
+                             const char *limit) {
+    if (kind == '"') {
+        for (; ptr < limit; ++ptr) {
+            if (escaped)
+                escaped = false;
+            else if (*ptr == '\\')
+                escaped = true;
+            else if (*ptr == '"')
+                return ptr + 1;
+        }
+    } else if (kind == '-' || (kind >= '0' && kind <= '9')) {
+        for (; ptr < limit; ++ptr) {
+            if (!std::strchr("0123456789+-.eE", *ptr) || !*ptr)
+                return ptr;
+        }
+    } else if (kind >= 'a' && kind <= 'z') {
+        for (; ptr < limit; ++ptr) {
+            if (*ptr < 'a' || *ptr > 'z')
+                return ptr;
+        }
+    } else {
+        return ptr;
     }
-ujson93:
-    ++m_cursor;
-    { return ujson_null; }
+    return nullptr;
 }
 
+struct ujson::incremental_parser::impl {
+    explicit impl(const parse_options &opts)
+        : builder(opts), opts(opts), escaped(false), lines(0) {}
+
+    // parse tokens in buffer; unless last, a token that may continue in
+    // the next chunk is saved as pending
+    void parse(const char *first, const char *limit, bool last);
+
+    value_builder builder;
+    parse_options opts;
+
+    // incomplete token at the end of the previous chunk
+    std::string pending;
+    bool escaped;
+
+    // number of lines in previous chunks
+    int lines;
+};
+
+void ujson::incremental_parser::impl::parse(const char *first,
+                                            const char *limit, bool last) {
+
+    if (first == limit)
+        return;
+
+    reader reader(first, limit - first);
+    try {
+        for (;;) {
+            auto t = reader.read_token();
+            auto token_first = reinterpret_cast<const char *>(reader.m_token);
+            if (t == token::eof) {
+                // embedded zeros are not allowed
+                if (token_first != limit)
+                    throw exception(error_code::invalid_syntax,
+                                    reader.line());
+                return;
+            }
+
+            // a number at the end of the chunk may have more digits
+            if (t == token::number && !last) {
+                bool unused = false;
+                if (!token_end(*token_first, unused, token_first + 1,
+                               limit)) {
+                    pending.assign(token_first, limit);
+                    return;
+                }
+            }
+            builder.push(t, reader);
+        }
+    } catch (exception const &e) {
+
+        // syntax errors in a token cut short by the end of the chunk
+        auto token_first = reinterpret_cast<const char *>(reader.m_token);
+        if (!last && e.get_error_code() == error_code::invalid_syntax &&
+            token_first != limit) {
+            escaped = false;
+            if (!token_end(*token_first, escaped, token_first + 1, limit)) {
+                pending.assign(token_first, limit);
+                return;
+            }
+        }
+
+        if (e.get_line() == -1)
+            throw;
+        throw exception(e.get_error_code(), lines + e.get_line());
+    }
 }
 
-//----------------------------------------------------------------------------
+ujson::incremental_parser::incremental_parser()
+    : incremental_parser(parse_options()) {}
 
-static ujson::value parse_value(parser &parser) {
-    switch (parser.peek_token()) {
-    case ujson_null:
-        parser.read_token();
-        return ujson::null;
-    case ujson_true:
-        parser.read_token();
-        return true;
-    case ujson_false:
-        parser.read_token();
-        return false;
-    case ujson_number:
-        parser.read_token();
-        return parser.read_double();
-    case ujson_string: {
-        parser.read_token();
-        auto string = parser.read_string();
-        return ujson::value(std::move(string), ujson::validate_utf8::no);
-    }
-    case ujson_array_begin: {
-        parser.read_token();
-        ujson::array array;
-        bool first = true;
-        while (parser.peek_token() != ujson_array_end) {
-            if (!first)
-                parser.expect(ujson_comma);
-            auto value = parse_value(parser);
-            array.push_back(std::move(value));
-            first = false;
+ujson::incremental_parser::incremental_parser(const parse_options &opts)
+    : m_impl(new impl(opts)) {}
+
+ujson::incremental_parser::~incremental_parser() {}
+
+void ujson::incremental_parser::feed(const char *buffer, std::size_t len) {
+
+    auto &impl = *m_impl;
+    auto first = buffer;
+    const auto limit = buffer + len;
+
+    try {
+        // complete token left over from previous chunk
+        if (!impl.pending.empty()) {
+            auto end = token_end(impl.pending[0], impl.escaped, first, limit);
+            if (!end) {
+                impl.pending.append(first, limit);
+                return;
+            }
+            impl.pending.append(first, end);
+            first = end;
+
+            std::string token;
+            token.swap(impl.pending);
+            impl.parse(token.data(), token.data() + token.size(), true);
         }
-        parser.read_token();
-        return ujson::value(std::move(array));
+
+        impl.parse(first, limit, false);
+        impl.lines += static_cast<int>(std::count(buffer, limit, '\n'));
+    } catch (...) {
+        m_impl.reset(new struct impl(impl.opts));
+        throw;
     }
-    case ujson_object_begin: {
-        parser.read_token();
-        ujson::object object;
-        bool first = true;
-        while (parser.peek_token() != ujson_object_end) {
-            if (!first)
-                parser.expect(ujson_comma);
-            parser.expect(ujson_string);
-            auto key = parser.read_string();
-            parser.expect(ujson_colon);
-            auto value = parse_value(parser);
-            object.emplace_back(std::move(key), std::move(value));
-            first = false;
+}
+
+ujson::value ujson::incremental_parser::finish() {
+
+    auto &impl = *m_impl;
+    try {
+        if (!impl.pending.empty()) {
+            std::string token;
+            token.swap(impl.pending);
+            impl.parse(token.data(), token.data() + token.size(), true);
         }
-        parser.read_token();
-        return ujson::value(std::move(object), ujson::validate_utf8::no);
+
+        if (!impl.builder.done())
+            throw exception(error_code::invalid_syntax, impl.lines + 1);
+    } catch (...) {
+        m_impl.reset(new struct impl(impl.opts));
+        throw;
     }
-    default:
-        throw ujson::exception(ujson::error_code::invalid_syntax,
-                               parser.line());
+
+    auto result = impl.builder.take();
+    impl.lines = 0;
+    return result;
+}
+
+//----------------------------------------------------------------------------
+// array stream
+
+struct ujson::array_stream::impl {
+    impl(std::istream &stream) : stream(stream), done(false) {
+        parser.m_impl->builder.stream_elements(&elements);
+    }
+
+    // read and parse the next chunk
+    void read_chunk();
+
+    std::unique_ptr<std::ifstream> file;
+    std::istream &stream;
+    incremental_parser parser;
+    std::deque<value> elements;
+    std::vector<char> buffer;
+    bool done;
+
+    // error to throw once the elements before it have been returned
+    std::exception_ptr error;
+};
+
+void ujson::array_stream::impl::read_chunk() {
+    const std::size_t chunk_size = 64 * 1024;
+
+    if (stream.eof()) {
+        done = true;
+        parser.finish();
+        return;
     }
+
+    buffer.resize(chunk_size);
+    stream.read(buffer.data(), chunk_size);
+    auto read = static_cast<std::size_t>(stream.gcount());
+
+    // a stream that fails without reaching eof would never make progress
+    if (stream.bad() || (!stream && !stream.eof()) ||
+        (read == 0 && !stream.eof()))
+        throw exception(error_code::io_error);
+    parser.feed(buffer.data(), read);
 }
 
-ujson::value ujson::parse(const std::string &str) {
-    return parse(str.c_str(), str.size());
+ujson::array_stream::array_stream(std::istream &stream)
+    : m_impl(new impl(stream)) {}
+
+ujson::array_stream::array_stream(const std::string &filename) {
+    std::unique_ptr<std::ifstream> file(
+        new std::ifstream(filename.c_str(), std::ios::in | std::ios::binary));
+    if (!file->is_open())
+        throw exception(error_code::io_error);
+    m_impl.reset(new impl(*file));
+    m_impl->file = std::move(file);
 }
 
-ujson::value ujson::parse(const char *buffer, std::size_t len) {
+ujson::array_stream::~array_stream() {}
 
-    auto buf = reinterpret_cast<const std::uint8_t *>(buffer);
-    parser parser(buf, len ? len : std::strlen(buffer));
-    auto result = parse_value(parser);
+bool ujson::array_stream::next(value &v) {
 
-    // fail if trailing junk is found
-    if (parser.read_token() != ujson_eof)
-        throw ujson::exception(ujson::error_code::invalid_syntax, parser.line());
-    return result;
+    auto &impl = *m_impl;
+    while (impl.elements.empty()) {
+        if (impl.error) {
+            auto error = impl.error;
+            impl.error = nullptr;
+            std::rethrow_exception(error);
+        }
+        if (impl.done)
+            return false;
+
+        // the parser is reset by an error, so the stream ends with it
+        try {
+            impl.read_chunk();
+        } catch (...) {
+            impl.done = true;
+            impl.error = std::current_exception();
+        }
+    }
+
+    v = std::move(impl.elements.front());
+    impl.elements.pop_front();
+    return true;
 }
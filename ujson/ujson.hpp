@@ -24,13 +24,18 @@
 #define __UJSON_HPP__
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <initializer_list>
 #include <iosfwd>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 namespace ujson {
@@ -65,6 +70,7 @@ enum class value_type { null, boolean, number, string, array, object };
 
 class value;
 class string_view;
+enum class error_code;
 
 using string = std::string;
 using array = std::vector<value>;
@@ -90,6 +96,12 @@ public:
     // construct 32 bit unsigned int value
     value(std::uint32_t d) noexcept;
 
+    // construct 64 bit signed int value; stored exactly
+    value(std::int64_t d) noexcept;
+
+    // construct 64 bit unsigned int value; stored exactly
+    value(std::uint64_t d) noexcept;
+
     // construct string value; throws if invalid utf-8
     value(string const &str, validate_utf8 validate = validate_utf8::yes);
     value(string &&str, validate_utf8 validate = validate_utf8::yes);
@@ -140,6 +152,8 @@ public:
     value &operator=(double); // throws if not finite
     value &operator=(std::int32_t) noexcept;
     value &operator=(std::uint32_t) noexcept;
+    value &operator=(std::int64_t) noexcept;
+    value &operator=(std::uint64_t) noexcept;
     value &operator=(string const &); // throws if invalid utf-8
     value &operator=(string &&);      // throws if invalid utf-8
     value &operator=(const char *);   // throws if invalid utf-8
@@ -160,6 +174,18 @@ public:
     bool is_array() const noexcept;
     bool is_object() const noexcept;
 
+    // number stored as an exact integer; integers constructed from integer
+    // types or parsed without fraction or exponent are, if they fit
+    bool is_int64() const noexcept;
+    bool is_uint64() const noexcept;
+
+    // number stored as its text by parse_options::raw_numbers
+    bool is_raw_number() const noexcept;
+
+    // string referring to the parsed buffer, see
+    // parse_options::borrowed_strings
+    bool is_borrowed_string() const noexcept;
+
     value_type type() const noexcept;
 
     void swap(value &other) noexcept;
@@ -177,28 +203,53 @@ private:
     // contained bool (moved from value will be null)
     friend bool bool_cast(value &&v);
 
-    // contained double
+    // contained number as double
     friend double double_cast(value const &v);
 
-    // contained double (moved from value will be null)
+    // contained number as double (moved from value will be null)
     friend double double_cast(value &&v);
 
-    // contained double cast to int32
+    // contained number cast to int32
     // throws integer_overflow if number is out of range
     friend std::int32_t int32_cast(value const &v);
 
-    // contained double cast to int32 (moved from value will be null)
+    // contained number cast to int32 (moved from value will be null)
     // throws integer_overflow if number is out of range
     friend std::int32_t int32_cast(value &&v);
 
-    // contained double cast to uint32
+    // contained number cast to uint32
     // throws integer_overflow if number is out of range
     friend std::uint32_t uint32_cast(value const &v);
 
-    // contained double cast to uint32 (moved from value will be null)
+    // contained number cast to uint32 (moved from value will be null)
     // throws integer_overflow if number is out of range
     friend std::uint32_t uint32_cast(value &&v);
 
+    // contained number cast to int64
+    // throws integer_overflow if number is out of range
+    friend std::int64_t int64_cast(value const &v);
+
+    // contained number cast to int64 (moved from value will be null)
+    // throws integer_overflow if number is out of range
+    friend std::int64_t int64_cast(value &&v);
+
+    // contained number cast to uint64
+    // throws integer_overflow if number is out of range
+    friend std::uint64_t uint64_cast(value const &v);
+
+    // contained number cast to uint64 (moved from value will be null)
+    // throws integer_overflow if number is out of range
+    friend std::uint64_t uint64_cast(value &&v);
+
+    // contained number cast to integer type T
+    template <typename T> static T integer_cast(value const &v);
+
+    // text of number parsed with parse_options::raw_numbers
+    friend string_view raw_number_cast(value const &v);
+
+    friend class reader;
+    friend class document;
+
     // const reference to contained string
     friend string_view string_cast(value const &v);
 
@@ -247,6 +298,22 @@ private:
         double number;
     };
 
+    struct int64_impl_t : impl_t {
+        int64_impl_t(std::int64_t n) noexcept;
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        std::int64_t number;
+    };
+
+    struct uint64_impl_t : impl_t {
+        uint64_impl_t(std::uint64_t n) noexcept;
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        std::uint64_t number;
+    };
+
 #ifdef UJSON_SHORT_STRING_OPTIMIZATION
 
     struct short_string_impl_t : impl_t {
@@ -268,6 +335,25 @@ private:
         std::shared_ptr<string> ptr;
     };
 
+    // number text kept by parse_options::raw_numbers; equals compares the
+    // text, operator== the converted values
+    struct short_raw_number_impl_t : impl_t {
+        short_raw_number_impl_t(const char *ptr, std::size_t len);
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        char buffer[sso_max_length + 1];
+        std::uint8_t length;
+    };
+
+    struct long_raw_number_impl_t : impl_t {
+        long_raw_number_impl_t(std::shared_ptr<string> const &p);
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        std::shared_ptr<string> ptr;
+    };
+
 #elif defined UJSON_REF_COUNTED_STRING
 
     struct string_impl_t : impl_t {
@@ -278,8 +364,28 @@ private:
         string str;
     };
 
+    // number text kept by parse_options::raw_numbers; equals compares the
+    // text, operator== the converted values
+    struct raw_number_impl_t : impl_t {
+        raw_number_impl_t(string s);
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        string str;
+    };
+
 #endif
 
+    // string in a buffer owned by the caller
+    struct borrowed_string_impl_t : impl_t {
+        borrowed_string_impl_t(const char *p, std::size_t len) noexcept;
+        value_type type() const noexcept override;
+        void clone(char *storage) const noexcept override;
+        bool equals(const impl_t *ptr) const noexcept override;
+        const char *ptr;
+        std::size_t length;
+    };
+
     struct array_impl_t : impl_t {
         array_impl_t(array a);
         array_impl_t(const std::shared_ptr<array> &p);
@@ -305,6 +411,23 @@ private:
 
     static bool is_valid_utf8(const char *start, const char *end) noexcept;
 
+    // equality of numbers with different representations
+    static bool number_equals(const value &lhs, const value &rhs);
+
+    // number value kept as text
+    static value make_raw_number(const char *ptr, std::size_t len);
+
+    // string value referring to ptr, which must outlive it
+    static value make_borrowed_string(const char *ptr,
+                                      std::size_t len) noexcept;
+
+    // array or object value sharing ptr; objects must be sorted
+    static value make_array(const std::shared_ptr<array> &ptr) noexcept;
+    static value make_object(const std::shared_ptr<object> &ptr) noexcept;
+
+    // convert raw number to int64, uint64 or double, as parse would
+    static value convert_raw_number(const value &v);
+
 public:
 #define UJSON_MAX(a, b) (((a) > (b)) ? (a) : (b))
 
@@ -314,23 +437,35 @@ public:
         UJSON_MAX(
             sizeof(boolean_impl_t),
             UJSON_MAX(
-                sizeof(number_impl_t),
+                UJSON_MAX(sizeof(number_impl_t),
+                          UJSON_MAX(sizeof(int64_impl_t),
+                                    sizeof(uint64_impl_t))),
                 UJSON_MAX(
                     sizeof(array_impl_t),
                     UJSON_MAX(sizeof(object_impl_t),
                               UJSON_MAX(sizeof(short_string_impl_t),
                                         sizeof(long_string_impl_t)))))));
+    static_assert(sizeof(short_raw_number_impl_t) <= storage_size &&
+                      sizeof(long_raw_number_impl_t) <= storage_size &&
+                      sizeof(borrowed_string_impl_t) <= storage_size,
+                  "raw numbers and borrowed strings must fit in value");
 #elif defined UJSON_REF_COUNTED_STRING
     static const std::size_t storage_size = UJSON_MAX(
         sizeof(null_impl_t),
         UJSON_MAX(sizeof(boolean_impl_t),
-                  UJSON_MAX(sizeof(number_impl_t),
+                  UJSON_MAX(UJSON_MAX(sizeof(number_impl_t),
+                                      UJSON_MAX(sizeof(int64_impl_t),
+                                                sizeof(uint64_impl_t))),
                             UJSON_MAX(sizeof(array_impl_t),
                                       UJSON_MAX(sizeof(object_impl_t),
                                                 sizeof(string_impl_t))))));
+    static_assert(sizeof(raw_number_impl_t) <= storage_size &&
+                      sizeof(borrowed_string_impl_t) <= storage_size,
+                  "raw numbers and borrowed strings must fit in value");
 #endif
 #undef UJSON_MAX
-    char m_storage[storage_size];
+    // aligned for the impl types, wherever the value itself is placed
+    alignas(std::max_align_t) char m_storage[storage_size];
 };
 
 void swap(value &lhs, value &rhs) noexcept;
@@ -347,6 +482,7 @@ public:
     string_view(const char *ptr, std::size_t len);
 
     const char *c_str() const;
+    const char *data() const;
     std::size_t length() const;
 
     operator std::string() const;
@@ -385,12 +521,732 @@ std::ostream &operator<<(std::ostream &stream, value const &v);
 value parse(const char *buffer, std::size_t len = 0);
 value parse(const std::string &buffer);
 
+struct parse_options {
+    parse_options();
+
+    // keep numbers as their text, converted only when cast; to_string
+    // writes the text unchanged, so decimals of any precision pass through
+    bool raw_numbers;
+
+    // string values without escapes refer to the parsed buffer instead of
+    // copying it, so the buffer must outlive the values; their views are
+    // not zero terminated; object names are always copied
+    bool borrowed_strings;
+
+    // maximum nesting of arrays and objects; deeper input throws too_deep
+    // before using more memory. The parsers keep their own stack, so thread
+    // stack use does not depend on the depth
+    std::size_t max_depth;
+};
+
+value parse(const char *buffer, std::size_t len, const parse_options &opts);
+value parse(const std::string &buffer, const parse_options &opts);
+
+// parse the value at the start of buffer, which may be followed by anything;
+// consumed is set to the offset of the byte following it; if len==0 buffer
+// must be zero terminated
+value parse_prefix(const char *buffer, std::size_t len, std::size_t &consumed);
+value parse_prefix(const char *buffer, std::size_t len, std::size_t &consumed,
+                   const parse_options &opts);
+
+// number of readable bytes parse_padded requires after the input; the
+// first of them must be zero
+enum { padding = 64 };
+
+// copy of some input followed by padding zero bytes
+class padded_buffer {
+public:
+    padded_buffer();
+
+    // len bytes to be filled in through data(), e.g. by reading a file
+    explicit padded_buffer(std::size_t len);
+
+    padded_buffer(const char *data, std::size_t len);
+    explicit padded_buffer(const std::string &str);
+
+    char *data() noexcept;
+    const char *data() const noexcept;
+    std::size_t size() const noexcept;
+
+private:
+    std::unique_ptr<char[]> m_data;
+    std::size_t m_size;
+};
+
+// as parse, but since the input is padded the scanner can run without
+// bounds checks; if len==0 buffer must be zero terminated
+value parse_padded(const char *buffer, std::size_t len);
+value parse_padded(const padded_buffer &buffer);
+value parse_padded(const char *buffer, std::size_t len,
+                   const parse_options &opts);
+value parse_padded(const padded_buffer &buffer, const parse_options &opts);
+
+// as parse with parse_options::borrowed_strings, but escaped strings are
+// unescaped in place too and every string value is zero terminated where
+// its closing quote was; buffer is modified and must outlive the result
+value parse_insitu(char *buffer, std::size_t len = 0);
+value parse_insitu(char *buffer, std::size_t len, const parse_options &opts);
+
+// parse a file through a read-only memory mapping instead of a copy; the
+// zero filled rest of its last page serves as padding where there is room.
+// parse_options::borrowed_strings is ignored, since the mapping is released
+// on return. Throws io_error if the file cannot be opened or mapped, and
+// invalid_syntax if it is empty
+value parse_file(const std::string &path);
+value parse_file(const std::string &path, const parse_options &opts);
+
+class reader;
+
+// paths into a document for parse_projected, as JSON pointers such as
+// "/user/id"; a "*" segment matches every member or element, as in
+// "/items/*/price", and "" selects the whole document. Throws
+// std::invalid_argument if a path does not start with '/'
+class projection {
+public:
+    projection(std::initializer_list<std::string> paths);
+    explicit projection(const std::vector<std::string> &paths);
+    ~projection();
+
+private:
+    struct node;
+
+    void add(const std::string &path);
+
+    // parse the next value, keeping what n selects from it into result at
+    // the given depth; returns false if nothing is selected
+    bool parse(reader &reader, const node &n, const parse_options &opts,
+               std::size_t depth, value &result) const;
+
+    std::unique_ptr<node> m_root;
+
+    friend value parse_projected(const char *buffer, std::size_t len,
+                                 const projection &paths,
+                                 const parse_options &opts);
+};
+
+// parse only the values selected by paths, within the arrays and objects
+// that lead to them; the rest is skipped by matching brackets and quotes,
+// so errors in it are not detected. Array elements keep their index, with
+// null for those not selected before the last one that is. Returns null if
+// nothing is selected; if len==0 buffer must be zero terminated
+value parse_projected(const char *buffer, std::size_t len,
+                      const projection &paths,
+                      const parse_options &opts = parse_options());
+value parse_projected(const std::string &buffer, const projection &paths,
+                      const parse_options &opts = parse_options());
+
+// parses into memory owned by the document: string contents and the
+// shared parts of arrays and objects are bump allocated from an arena, and
+// element storage is allocated once at its final size; the arena is kept
+// for the next parse, so a long lived, e.g. thread_local, document needs
+// no allocation for them after the first few parses
+// values from a document, including copies, must not outlive it or its
+// next parse
+class document {
+public:
+    document();
+    ~document();
+
+    // parse buffer, replacing the previous value; if len==0 buffer must be
+    // zero terminated; throws if buffer is not valid JSON
+    const value &parse(const char *buffer, std::size_t len = 0);
+    const value &parse(const char *buffer, std::size_t len,
+                       const parse_options &opts);
+    const value &parse(const std::string &buffer);
+    const value &parse(const std::string &buffer, const parse_options &opts);
+
+    // value of the last parse; null before the first parse and after a
+    // failed one
+    const value &root() const noexcept;
+
+    // bytes reserved by the arena
+    std::size_t capacity() const noexcept;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+};
+
+// ----------------------------------------------------------------------------
+// tape
+//
+// A tape is a read-only alternative to value: parsing writes one array of
+// 64-bit words plus a buffer with the string contents. Each word holds a
+// tag in its top byte. Numbers and strings use a second word for their bits
+// or length, arrays and objects a second word for their element count and
+// store their total number of words in the first, so they can be skipped
+// in constant time. Objects keep their members in input order.
+
+class array_view;
+class object_view;
+
+// handle to a value on a tape; valid until the tape is parsed again
+class element {
+public:
+    value_type type() const noexcept;
+
+private:
+    enum tag : std::uint64_t {
+        null_tag,
+        true_tag,
+        false_tag,
+        int64_tag,
+        uint64_tag,
+        double_tag,
+        string_tag,
+        array_tag,
+        object_tag
+    };
+    enum { tag_shift = 56 };
+
+    element(const std::uint64_t *word, const char *strings) noexcept;
+
+    tag get_tag() const noexcept;
+    std::uint64_t payload() const noexcept;
+
+    // word following the value at word
+    static const std::uint64_t *skip(const std::uint64_t *word) noexcept;
+
+    // number as a value, so the value casts can be reused
+    value number() const;
+
+    const std::uint64_t *m_word;
+    const char *m_strings;
+
+    friend class tape;
+    friend class array_view;
+    friend class object_view;
+    friend bool bool_cast(element e);
+    friend double double_cast(element e);
+    friend std::int32_t int32_cast(element e);
+    friend std::uint32_t uint32_cast(element e);
+    friend std::int64_t int64_cast(element e);
+    friend std::uint64_t uint64_cast(element e);
+    friend string_view string_cast(element e);
+    friend array_view array_cast(element e);
+    friend object_view object_cast(element e);
+    friend value to_value(element e);
+};
+
+// the casts behave as those for value and throw bad_cast if the element is
+// of a different type
+bool bool_cast(element e);
+double double_cast(element e);
+std::int32_t int32_cast(element e);
+std::uint32_t uint32_cast(element e);
+std::int64_t int64_cast(element e);
+std::uint64_t uint64_cast(element e);
+string_view string_cast(element e); // zero terminated
+array_view array_cast(element e);
+object_view object_cast(element e);
+
+// copy element into a value
+value to_value(element e);
+
+class array_view {
+public:
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef element value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const element *pointer;
+        typedef element reference;
+
+        element operator*() const noexcept;
+        iterator &operator++() noexcept;
+        iterator operator++(int) noexcept;
+        bool operator==(const iterator &rhs) const noexcept;
+        bool operator!=(const iterator &rhs) const noexcept;
+
+    private:
+        iterator(const std::uint64_t *word, const char *strings) noexcept;
+
+        const std::uint64_t *m_word;
+        const char *m_strings;
+
+        friend class array_view;
+    };
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    // element i, found in linear time
+    element operator[](std::size_t i) const noexcept;
+
+private:
+    explicit array_view(element e) noexcept;
+
+    element m_element;
+
+    friend array_view array_cast(element e);
+};
+
+class object_view {
+public:
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<string_view, element> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type *pointer;
+        typedef value_type reference;
+
+        std::pair<string_view, element> operator*() const noexcept;
+        iterator &operator++() noexcept;
+        iterator operator++(int) noexcept;
+        bool operator==(const iterator &rhs) const noexcept;
+        bool operator!=(const iterator &rhs) const noexcept;
+
+    private:
+        iterator(const std::uint64_t *word, const char *strings) noexcept;
+
+        const std::uint64_t *m_word;
+        const char *m_strings;
+
+        friend class object_view;
+    };
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+private:
+    explicit object_view(element e) noexcept;
+
+    element m_element;
+
+    friend object_view object_cast(element e);
+};
+
+// first member with the given name, or end(); linear time
+object_view::iterator find(object_view obj, char const *name);
+
+class tape {
+public:
+    tape();
+
+    // parse buffer, replacing the previous contents; if len==0 buffer must
+    // be zero terminated; throws if buffer is not valid JSON, leaving the
+    // tape empty
+    element parse(const char *buffer, std::size_t len = 0);
+    element parse(const std::string &buffer);
+
+    // only parse_options::max_depth applies
+    element parse(const char *buffer, std::size_t len,
+                  const parse_options &opts);
+
+    // root of the last successful parse; null if the tape is empty
+    element root() const noexcept;
+
+    // number of words on the tape
+    std::size_t size() const noexcept;
+
+private:
+    // append the next value from reader
+    void append(reader &reader, const parse_options &opts);
+    void append_string(std::uint64_t tag, string_view str);
+
+    // offset in m_strings of the only copy of an object name
+    std::uint64_t intern(string_view name);
+
+    std::vector<std::uint64_t> m_words;
+    std::string m_strings;
+
+    // the distinct object names on the tape, as offset + 1 and length, in
+    // an open addressing table that is at most half full; 0 marks a free
+    // slot
+    std::vector<std::pair<std::uint64_t, std::size_t>> m_names;
+    std::size_t m_name_count;
+};
+
+// receives parse events; override the callbacks of interest
+// string views are only valid for the duration of the callback and are not
+// zero terminated
+class handler {
+public:
+    virtual ~handler();
+
+    virtual void on_null();
+    virtual void on_bool(bool b);
+    virtual void on_number(double d);
+
+    // integers without fraction or exponent that fit; by default passed to
+    // on_number
+    virtual void on_int64(std::int64_t i);
+    virtual void on_uint64(std::uint64_t u);
+    virtual void on_string(string_view str);
+    virtual void on_start_array();
+    virtual void on_end_array();
+    virtual void on_start_object();
+    virtual void on_key(string_view key);
+    virtual void on_end_object();
+};
+
+// parse buffer and report contents to handler without building values
+// if len==0 buffer must be zero terminated; throws if not valid JSON
+void parse(const char *buffer, std::size_t len, handler &h);
+void parse(const std::string &buffer, handler &h);
+
+// as above; only parse_options::max_depth applies
+void parse(const char *buffer, std::size_t len, handler &h,
+           const parse_options &opts);
+
+enum class token {
+    colon,
+    comma,
+    null,
+    true_value,
+    false_value,
+    number,
+    string,
+    array_begin,
+    array_end,
+    object_begin,
+    object_end,
+    eof
+};
+
+// whether input is followed by ujson::padding readable bytes
+enum class padded { no, yes };
+
+// pull based cursor over the tokens of a buffer, which must outlive it;
+// methods throw on lexical errors, such as invalid tokens, strings or
+// numbers, but checking the grammar, e.g. that commas separate elements,
+// is up to the caller
+class reader {
+public:
+    // if len==0 buffer must be zero terminated
+    reader(const char *buffer, std::size_t len = 0, padded p = padded::no);
+    explicit reader(const padded_buffer &buffer);
+
+    // next token without consuming it
+    token peek_token();
+
+    // consume next token
+    token read_token();
+
+    // consume next token; throws invalid_syntax if it is not t
+    void expect(token t);
+
+    // contents of last consumed number token
+    double read_double() const;
+
+    // contents of last consumed number token if it is an integer without
+    // fraction or exponent that fits; returns false otherwise
+    bool read_int64(std::int64_t &i) const;
+    bool read_uint64(std::uint64_t &u) const;
+
+    // contents of last consumed number token as a value keeping its text;
+    // see parse_options::raw_numbers
+    value read_raw_number() const;
+
+    // contents of last consumed string token
+    std::string read_string() const;
+    void read_string(std::string &result) const;
+
+    // contents of last consumed string token without copying, if it has no
+    // escapes; otherwise valid until next call; not zero terminated
+    string_view read_string_view();
+
+    // contents of last consumed string token as a value referring to the
+    // buffer if it has no escapes, a copy otherwise; see
+    // parse_options::borrowed_strings
+    value read_borrowed_string();
+
+    // as read_borrowed_string, but buffer is the input passed to the
+    // constructor, made writable: escaped contents are unescaped in place
+    // and the closing quote is replaced by a zero terminator
+    value read_string_insitu(char *buffer);
+
+    // consume next value, including nested arrays and objects, without
+    // converting strings or numbers
+    void skip_value();
+
+    // consume next value and return it
+    value read_value();
+
+    // line number of current position
+    int line() const;
+
+    // offset from the start of the buffer of the first byte of the last
+    // scanned token, including a peeked one, and of the byte following it
+    std::size_t token_offset() const;
+    std::size_t offset() const;
+
+    // keep the first error instead of throwing it; from then on failed(),
+    // error() and error_offset() describe that error, and any tokens read
+    // after it are meaningless
+    void record_errors();
+    bool failed() const;
+    error_code error() const;
+    std::size_t error_offset() const; // token_offset() of the error
+
+    // throw code at the current line, or keep it if errors are recorded
+    void fail(error_code code) const;
+
+private:
+    // provides a sentinel token to the scanner when it reads beyond the
+    // supplied buffer
+    class safe_ptr {
+    public:
+        safe_ptr(const std::uint8_t *ptr, const std::uint8_t *limit);
+
+        inline const std::uint8_t *ptr() const;
+        inline const std::uint8_t *limit() const;
+
+        inline std::uint8_t operator*() const;
+        inline operator const std::uint8_t *() const;
+
+        inline safe_ptr &operator++();
+        inline safe_ptr &operator+=(std::size_t);
+
+        inline safe_ptr &operator=(const std::uint8_t *);
+
+    private:
+        const std::uint8_t *m_ptr;
+        const std::uint8_t *m_limit;
+    };
+
+    token scan();
+    token scan_string(const std::uint8_t *first);
+    token scan_number(const std::uint8_t *first);
+    token scan_error();
+
+    // run the dfa; cursor_type is a safe_ptr or, for padded input, a raw
+    // pointer
+    template <typename cursor_type> token scan(cursor_type &cursor);
+
+    // stage 1: classify the 64 bytes at block into the bitmaps below
+    void classify(const std::uint8_t *block);
+
+    const std::uint8_t *m_start;
+    const std::uint8_t *m_limit;
+    bool m_padded;
+
+    bool m_peeked;
+    token m_current_token;
+
+    const std::uint8_t *m_cursor;
+    const std::uint8_t *m_token;
+
+    // one bit per byte of the block at m_block; bytes past m_limit are zero
+    const std::uint8_t *m_block;
+    std::uint64_t m_whitespace;
+    std::uint64_t m_quotes;
+    std::uint64_t m_special; // backslash and control bytes
+    std::uint64_t m_non_ascii;
+
+    // unescaped contents of last string token, if it has escapes
+    bool m_escaped;
+    std::string m_buffer;
+
+    // line feeds unescaped into the input by read_string_insitu
+    std::ptrdiff_t m_insitu_lines;
+
+    bool m_record_errors;
+    mutable bool m_failed;
+    mutable error_code m_error;
+    mutable std::size_t m_error_offset;
+
+    // last number token is significand * 10^exponent; with more than 19
+    // significant digits it is converted from the text instead
+    std::uint64_t m_significand;
+    std::int64_t m_exponent;
+    bool m_negative;
+    bool m_many_digits;
+    bool m_integer; // no fraction or exponent and significand is exact
+
+    // consume next value like skip_value, but past its first token only
+    // brackets and quotes are matched, so errors inside it are not detected
+    void skip_value_unchecked();
+
+    // consume the rest of the depth innermost open arrays and objects in the
+    // same way
+    void skip_unchecked(std::size_t depth);
+
+    friend class incremental_parser;
+    friend class projection;
+};
+
+// push parser for input arriving in chunks, e.g. from a socket; only a
+// token straddling two chunks is buffered, never the whole document
+class incremental_parser {
+public:
+    incremental_parser();
+
+    // parse_options::borrowed_strings is ignored, since the chunks need not
+    // outlive the parser
+    explicit incremental_parser(const parse_options &opts);
+
+    ~incremental_parser();
+
+    // parse next chunk; throws if the input so far is not valid JSON
+    void feed(const char *buffer, std::size_t len);
+
+    // signal end of input; returns the value and resets the parser
+    // throws if the input is incomplete
+    value finish();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+
+    friend class array_stream;
+};
+
+// reads the elements of a top level array from a stream in 64 KiB chunks,
+// so only the elements completed by the last chunk read and the input
+// buffer are kept in memory
+class array_stream {
+public:
+    // read from stream, which must outlive the array_stream
+    explicit array_stream(std::istream &stream);
+
+    // read from file; throws io_error if it cannot be opened
+    explicit array_stream(const std::string &filename);
+
+    ~array_stream();
+
+    // read next element; returns false after the last element
+    // throws if the input is not a valid JSON array or cannot be read, once
+    // the elements before the error have been returned; after that the
+    // stream is at its end
+    bool next(value &v);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+};
+
+// whether value_stream skips values that are not valid JSON
+enum class skip_invalid { no, yes };
+
+// reads the values of a buffer of concatenated JSON, e.g. newline delimited
+// JSON, with one scanner; the buffer must outlive the value_stream
+class value_stream {
+public:
+    // if len==0 buffer must be zero terminated
+    value_stream(const char *buffer, std::size_t len = 0,
+                 skip_invalid skip = skip_invalid::no,
+                 const parse_options &opts = parse_options());
+
+    // parse next value; returns false after the last value
+    // an invalid value throws, or with skip_invalid::yes is counted and
+    // skipped; either way reading resumes on the line after the one the
+    // value starts on
+    bool next(value &v);
+
+    // offset from the start of the buffer of the last value read or failed
+    std::size_t offset() const noexcept;
+
+    // number of values skipped
+    std::size_t skipped() const noexcept;
+
+private:
+    // continue with a new reader at the start of the line after offset
+    void skip_line();
+
+    const char *m_buffer;
+    std::size_t m_length;
+    skip_invalid m_skip;
+    parse_options m_opts;
+
+    // the reader starts at m_base, which is on line m_lines + 1
+    std::size_t m_base;
+    int m_lines;
+    reader m_reader;
+
+    std::size_t m_offset;
+    std::size_t m_skipped;
+};
+
+value_stream parse_many(const char *buffer, std::size_t len = 0,
+                        skip_invalid skip = skip_invalid::no,
+                        const parse_options &opts = parse_options());
+
+struct parallel_options {
+    parallel_options();
+
+    // worker threads; 0 starts one per core
+    unsigned threads;
+
+    // approximate bytes per chunk; parallel_value_stream ends chunks after
+    // a line feed, so values must not span lines, as in newline delimited
+    // JSON
+    std::size_t chunk_size;
+
+    // parallel_value_stream only: chunks parsed or being parsed but not yet
+    // read, which bounds the memory used; 0 allows two per thread
+    std::size_t max_chunks;
+
+    // parallel_value_stream only: return values in input order, otherwise a
+    // chunk at a time as soon as it is parsed
+    bool ordered;
+};
+
+// as value_stream, but the buffer is split into chunks that are parsed by
+// a pool of worker threads
+class parallel_value_stream {
+public:
+    // if len==0 buffer must be zero terminated
+    parallel_value_stream(const char *buffer, std::size_t len = 0,
+                          skip_invalid skip = skip_invalid::no,
+                          const parse_options &opts = parse_options(),
+                          const parallel_options &parallel =
+                              parallel_options());
+
+    // stops the workers
+    ~parallel_value_stream();
+
+    // parse next value; returns false after the last value
+    // an invalid value throws, or with skip_invalid::yes is counted and
+    // skipped; either way reading resumes on the next line
+    bool next(value &v);
+
+    // offset from the start of the buffer of the last value read or failed
+    std::size_t offset() const noexcept;
+
+    // number of values skipped in the chunks read so far
+    std::size_t skipped() const noexcept;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+};
+
+// as parse, but the members of a top-level array or object are split into
+// chunks that are parsed on several threads; input smaller than two chunks
+// is parsed on the calling thread. Invalid input is parsed again by parse
+// to report the error. If len==0 buffer must be zero terminated
+value parse_parallel(const char *buffer, std::size_t len = 0,
+                     const parse_options &opts = parse_options(),
+                     const parallel_options &parallel = parallel_options());
+
+// instruction sets used by the scanner and serializer
+enum class simd_level { scalar, sse2, ssse3, avx2, avx512 };
+
+// best level supported by this cpu and build; selected at startup
+simd_level detect_simd_level();
+
+// level currently in use
+simd_level get_simd_level();
+
+// use level, or the best supported level below it; not thread safe, so
+// call before parsing, e.g. to test or benchmark the scalar code
+void set_simd_level(simd_level level);
+
 enum class error_code {
     bad_cast,        // value has wrong type for cast
     bad_number,      // number not finite (NaN/inf not supported by JSON)
     bad_string,      // invalid utf-8 string
-    invalid_syntax,  // error parsing JSON
-    integer_overflow // number is outside valid range for integer cast
+    invalid_syntax,   // error parsing JSON
+    integer_overflow, // number is outside valid range for integer cast
+    io_error,         // error opening or reading input
+    too_deep          // nesting exceeds parse_options::max_depth
 };
 
 class exception final : public std::exception {
@@ -410,6 +1266,31 @@ private:
     int m_line;
 };
 
+// where and why try_parse failed
+struct parse_error {
+    parse_error();
+
+    error_code code;
+
+    // offset from the start of the buffer of the token at fault
+    std::size_t offset;
+
+    // line and byte column of offset, both counted from 1
+    int line;
+    int column;
+};
+
+// as parse, but invalid input returns false with error filled in instead of
+// throwing, and result is left unchanged; if len==0 buffer must be zero
+// terminated
+bool try_parse(const char *buffer, std::size_t len, value &result,
+               parse_error &error);
+bool try_parse(const char *buffer, std::size_t len, value &result,
+               parse_error &error, const parse_options &opts);
+bool try_parse(const std::string &buffer, value &result, parse_error &error);
+bool try_parse(const std::string &buffer, value &result, parse_error &error,
+               const parse_options &opts);
+
 // find first value with given name; returns obj.end() if not found
 object::const_iterator find(object const &obj, char const *name);
 object::iterator find(object &obj, char const *name);
@@ -439,9 +1320,17 @@ inline value::value(double d) {
     new (m_storage) number_impl_t{ d };
 }
 
-inline value::value(std::int32_t i) noexcept : value(double(i)) {}
+inline value::value(std::int32_t i) noexcept : value(std::int64_t(i)) {}
 
-inline value::value(std::uint32_t i) noexcept : value(double(i)) {}
+inline value::value(std::uint32_t i) noexcept : value(std::int64_t(i)) {}
+
+inline value::value(std::int64_t i) noexcept {
+    new (m_storage) int64_impl_t{ i };
+}
+
+inline value::value(std::uint64_t i) noexcept {
+    new (m_storage) uint64_impl_t{ i };
+}
 
 inline value::value(string const &s, validate_utf8 validate) {
 
@@ -572,12 +1461,24 @@ inline value &value::operator=(double d) {
 }
 
 inline value &value::operator=(std::int32_t i) noexcept {
-    *this = double(i);
+    *this = std::int64_t(i);
     return *this;
 }
 
 inline value &value::operator=(std::uint32_t i) noexcept {
-    *this = double(i);
+    *this = std::int64_t(i);
+    return *this;
+}
+
+inline value &value::operator=(std::int64_t i) noexcept {
+    destroy();
+    new (m_storage) int64_impl_t{ i };
+    return *this;
+}
+
+inline value &value::operator=(std::uint64_t i) noexcept {
+    destroy();
+    new (m_storage) uint64_impl_t{ i };
     return *this;
 }
 
@@ -701,6 +1602,23 @@ inline bool value::is_array() const noexcept {
 inline bool value::is_object() const noexcept {
     return type() == value_type::object;
 }
+inline bool value::is_int64() const noexcept {
+    return typeid(*impl()) == typeid(int64_impl_t);
+}
+inline bool value::is_uint64() const noexcept {
+    return typeid(*impl()) == typeid(uint64_impl_t);
+}
+inline bool value::is_raw_number() const noexcept {
+#ifdef UJSON_SHORT_STRING_OPTIMIZATION
+    return typeid(*impl()) == typeid(short_raw_number_impl_t) ||
+           typeid(*impl()) == typeid(long_raw_number_impl_t);
+#elif defined UJSON_REF_COUNTED_STRING
+    return typeid(*impl()) == typeid(raw_number_impl_t);
+#endif
+}
+inline bool value::is_borrowed_string() const noexcept {
+    return typeid(*impl()) == typeid(borrowed_string_impl_t);
+}
 
 inline value_type value::type() const noexcept { return impl()->type(); }
 
@@ -724,8 +1642,22 @@ inline bool operator==(const value &lhs, const value &rhs) {
     auto lhs_impl = lhs.impl();
     auto rhs_impl = rhs.impl();
 
-    if (typeid(*lhs_impl) != typeid(*rhs_impl))
+    // numbers and strings are compared by value across representations
+    if (typeid(*lhs_impl) != typeid(*rhs_impl) || lhs.is_raw_number()) {
+        const auto type = lhs_impl->type();
+        if (type != rhs_impl->type())
+            return false;
+        if (type == value_type::number)
+            return value::number_equals(lhs, rhs);
+        if (type == value_type::string) {
+            auto lhs_str = string_cast(lhs);
+            auto rhs_str = string_cast(rhs);
+            return lhs_str.length() == rhs_str.length() &&
+                   std::memcmp(lhs_str.data(), rhs_str.data(),
+                               lhs_str.length()) == 0;
+        }
         return false;
+    }
 
     return lhs_impl->equals(rhs_impl);
 }
@@ -741,6 +1673,8 @@ inline string_view::string_view(const char *ptr, std::size_t len)
 
 inline const char *string_view::c_str() const { return m_ptr; }
 
+inline const char *string_view::data() const { return m_ptr; }
+
 inline std::size_t string_view::length() const { return m_length; }
 
 inline string_view::operator std::string() const {
@@ -755,12 +1689,76 @@ inline const char *string_view::end() const { return m_ptr + m_length; }
 
 inline const char *string_view::cend() const { return m_ptr + m_length; }
 
+// --------------------------------------------------------------------------
+
+inline padded_buffer::padded_buffer() : padded_buffer(std::size_t(0)) {}
+
+inline padded_buffer::padded_buffer(std::size_t len)
+    : m_data(new char[len + padding]()), m_size(len) {}
+
+inline padded_buffer::padded_buffer(const char *data, std::size_t len)
+    : padded_buffer(len) {
+    std::memcpy(m_data.get(), data, len);
+}
+
+inline padded_buffer::padded_buffer(const std::string &str)
+    : padded_buffer(str.data(), str.size()) {}
+
+inline char *padded_buffer::data() noexcept { return m_data.get(); }
+
+inline const char *padded_buffer::data() const noexcept {
+    return m_data.get();
+}
+
+inline std::size_t padded_buffer::size() const noexcept { return m_size; }
+
+// --------------------------------------------------------------------------
+
+inline parse_options::parse_options()
+    : raw_numbers(false), borrowed_strings(false), max_depth(1024) {}
+
+inline parallel_options::parallel_options()
+    : threads(0), chunk_size(1 << 20), max_chunks(0), ordered(true) {}
+
+inline parse_error::parse_error()
+    : code(error_code::invalid_syntax), offset(0), line(0), column(0) {}
+
 inline bool operator==(string_view const &lhs, string_view const &rhs) {
     return lhs.m_ptr == rhs.m_ptr && lhs.m_length == rhs.m_length;
 }
 
 // --------------------------------------------------------------------------
 
+inline handler::~handler() {}
+
+inline void handler::on_null() {}
+
+inline void handler::on_bool(bool) {}
+
+inline void handler::on_number(double) {}
+
+inline void handler::on_int64(std::int64_t i) {
+    on_number(static_cast<double>(i));
+}
+
+inline void handler::on_uint64(std::uint64_t u) {
+    on_number(static_cast<double>(u));
+}
+
+inline void handler::on_string(string_view) {}
+
+inline void handler::on_start_array() {}
+
+inline void handler::on_end_array() {}
+
+inline void handler::on_start_object() {}
+
+inline void handler::on_key(string_view) {}
+
+inline void handler::on_end_object() {}
+
+// --------------------------------------------------------------------------
+
 inline bool bool_cast(value const &v) {
     auto ptr = dynamic_cast<const value::boolean_impl_t *>(v.impl());
     if (ptr)
@@ -778,65 +1776,109 @@ inline bool bool_cast(value &&v) {
 }
 
 inline double double_cast(value const &v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (ptr)
+    if (v.is_raw_number())
+        return double_cast(value::convert_raw_number(v));
+    auto impl = v.impl();
+    if (auto ptr = dynamic_cast<const value::number_impl_t *>(impl))
         return ptr->number;
+    if (auto ptr = dynamic_cast<const value::int64_impl_t *>(impl))
+        return static_cast<double>(ptr->number);
+    if (auto ptr = dynamic_cast<const value::uint64_impl_t *>(impl))
+        return static_cast<double>(ptr->number);
     throw exception(error_code::bad_cast);
 }
 
 inline double double_cast(value &&v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (!ptr)
-        throw exception(error_code::bad_cast);
-    double tmp = ptr->number;
+    double tmp = double_cast(static_cast<value const &>(v));
     v = null;
     return tmp;
 }
 
+template <typename T> inline T value::integer_cast(value const &v) {
+    if (v.is_raw_number())
+        return integer_cast<T>(convert_raw_number(v));
+    typedef std::numeric_limits<T> limits;
+    auto impl = v.impl();
+    if (auto ptr = dynamic_cast<const int64_impl_t *>(impl)) {
+        if (ptr->number < 0 ? ptr->number < std::int64_t(limits::min())
+                            : std::uint64_t(ptr->number) >
+                                  std::uint64_t(limits::max()))
+            throw exception(error_code::integer_overflow);
+        return T(ptr->number);
+    }
+    if (auto ptr = dynamic_cast<const uint64_impl_t *>(impl)) {
+        if (ptr->number > std::uint64_t(limits::max()))
+            throw exception(error_code::integer_overflow);
+        return T(ptr->number);
+    }
+    if (auto ptr = dynamic_cast<const number_impl_t *>(impl)) {
+        // max() + 1 is a power of two, so exact as a double
+        if (ptr->number < double(limits::min()) ||
+            ptr->number >= double(limits::max() / 2 + 1) * 2)
+            throw exception(error_code::integer_overflow);
+        return T(ptr->number);
+    }
+    throw exception(error_code::bad_cast);
+}
+
 inline std::int32_t int32_cast(value const &v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (!ptr)
-        throw exception(error_code::bad_cast);
-    if (ptr->number < std::numeric_limits<std::int32_t>::min() ||
-        ptr->number > std::numeric_limits<std::int32_t>::max())
-        throw exception(error_code::integer_overflow);
-    return std::int32_t(ptr->number);
+    return value::integer_cast<std::int32_t>(v);
 }
 
 inline std::int32_t int32_cast(value &&v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (!ptr)
-        throw exception(error_code::bad_cast);
-    if (ptr->number < std::numeric_limits<std::int32_t>::min() ||
-        ptr->number > std::numeric_limits<std::int32_t>::max())
-        throw exception(error_code::integer_overflow);
-    std::int32_t tmp = std::int32_t(ptr->number);
+    std::int32_t tmp = int32_cast(static_cast<value const &>(v));
     v = null;
     return tmp;
 }
 
 inline std::uint32_t uint32_cast(value const &v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (!ptr)
-        throw exception(error_code::bad_cast);
-    if (ptr->number < std::numeric_limits<std::uint32_t>::min() ||
-        ptr->number > std::numeric_limits<std::uint32_t>::max())
-        throw exception(error_code::integer_overflow);
-    return std::uint32_t(ptr->number);
+    return value::integer_cast<std::uint32_t>(v);
 }
 
 inline std::uint32_t uint32_cast(value &&v) {
-    auto ptr = dynamic_cast<const value::number_impl_t *>(v.impl());
-    if (!ptr)
-        throw exception(error_code::bad_cast);
-    if (ptr->number < std::numeric_limits<std::uint32_t>::min() ||
-        ptr->number > std::numeric_limits<std::uint32_t>::max())
-        throw exception(error_code::integer_overflow);
-    std::uint32_t tmp = std::uint32_t(ptr->number);
+    std::uint32_t tmp = uint32_cast(static_cast<value const &>(v));
     v = null;
     return tmp;
 }
 
+inline std::int64_t int64_cast(value const &v) {
+    return value::integer_cast<std::int64_t>(v);
+}
+
+inline std::int64_t int64_cast(value &&v) {
+    std::int64_t tmp = int64_cast(static_cast<value const &>(v));
+    v = null;
+    return tmp;
+}
+
+inline std::uint64_t uint64_cast(value const &v) {
+    return value::integer_cast<std::uint64_t>(v);
+}
+
+inline std::uint64_t uint64_cast(value &&v) {
+    std::uint64_t tmp = uint64_cast(static_cast<value const &>(v));
+    v = null;
+    return tmp;
+}
+
+inline string_view raw_number_cast(value const &v) {
+#ifdef UJSON_SHORT_STRING_OPTIMIZATION
+    auto short_impl =
+        dynamic_cast<const value::short_raw_number_impl_t *>(v.impl());
+    if (short_impl)
+        return { short_impl->buffer, short_impl->length };
+    auto long_impl =
+        dynamic_cast<const value::long_raw_number_impl_t *>(v.impl());
+    if (long_impl)
+        return { long_impl->ptr->c_str(), long_impl->ptr->length() };
+#elif defined UJSON_REF_COUNTED_STRING
+    auto impl = dynamic_cast<const value::raw_number_impl_t *>(v.impl());
+    if (impl)
+        return { impl->str.c_str(), impl->str.length() };
+#endif
+    throw exception(error_code::bad_cast);
+}
+
 inline string_view string_cast(value const &v) {
 #ifdef UJSON_SHORT_STRING_OPTIMIZATION
     auto short_impl =
@@ -852,10 +1894,22 @@ inline string_view string_cast(value const &v) {
     if (impl)
         return { impl->str.c_str(), impl->str.length() };
 #endif
+    auto borrowed_impl =
+        dynamic_cast<const value::borrowed_string_impl_t *>(v.impl());
+    if (borrowed_impl)
+        return { borrowed_impl->ptr, borrowed_impl->length };
     throw exception(error_code::bad_cast);
 }
 
 inline string string_cast(value &&v) {
+    auto borrowed_impl =
+        dynamic_cast<const value::borrowed_string_impl_t *>(v.impl());
+    if (borrowed_impl) {
+        std::string tmp(borrowed_impl->ptr,
+                        borrowed_impl->ptr + borrowed_impl->length);
+        v = null;
+        return tmp;
+    }
 #ifdef UJSON_SHORT_STRING_OPTIMIZATION
     auto short_impl =
         dynamic_cast<const value::short_string_impl_t *>(v.impl());
@@ -967,6 +2021,241 @@ inline object::iterator at(object &obj, char const *name) {
 
 // --------------------------------------------------------------------------
 
+inline element::element(const std::uint64_t *word,
+                        const char *strings) noexcept
+    : m_word(word), m_strings(strings) {}
+
+inline element::tag element::get_tag() const noexcept {
+    return tag(*m_word >> tag_shift);
+}
+
+inline std::uint64_t element::payload() const noexcept {
+    return *m_word & ((std::uint64_t(1) << tag_shift) - 1);
+}
+
+inline const std::uint64_t *element::skip(const std::uint64_t *word) noexcept {
+    switch (tag(*word >> tag_shift)) {
+    case null_tag:
+    case true_tag:
+    case false_tag:
+        return word + 1;
+    case array_tag:
+    case object_tag:
+        return word + (*word & ((std::uint64_t(1) << tag_shift) - 1));
+    default:
+        return word + 2;
+    }
+}
+
+inline value_type element::type() const noexcept {
+    switch (get_tag()) {
+    case null_tag:
+        return value_type::null;
+    case true_tag:
+    case false_tag:
+        return value_type::boolean;
+    case string_tag:
+        return value_type::string;
+    case array_tag:
+        return value_type::array;
+    case object_tag:
+        return value_type::object;
+    default:
+        return value_type::number;
+    }
+}
+
+inline value element::number() const {
+    switch (get_tag()) {
+    case int64_tag:
+        return std::int64_t(m_word[1]);
+    case uint64_tag:
+        return std::uint64_t(m_word[1]);
+    case double_tag: {
+        double d;
+        std::memcpy(&d, m_word + 1, sizeof(d));
+        return d;
+    }
+    default:
+        throw exception(error_code::bad_cast);
+    }
+}
+
+inline bool bool_cast(element e) {
+    if (e.get_tag() == element::true_tag)
+        return true;
+    if (e.get_tag() == element::false_tag)
+        return false;
+    throw exception(error_code::bad_cast);
+}
+
+inline double double_cast(element e) {
+    switch (e.get_tag()) {
+    case element::int64_tag:
+        return double(std::int64_t(e.m_word[1]));
+    case element::uint64_tag:
+        return double(e.m_word[1]);
+    case element::double_tag: {
+        double d;
+        std::memcpy(&d, e.m_word + 1, sizeof(d));
+        return d;
+    }
+    default:
+        throw exception(error_code::bad_cast);
+    }
+}
+
+inline std::int32_t int32_cast(element e) { return int32_cast(e.number()); }
+
+inline std::uint32_t uint32_cast(element e) {
+    return uint32_cast(e.number());
+}
+
+inline std::int64_t int64_cast(element e) {
+    if (e.get_tag() == element::int64_tag)
+        return std::int64_t(e.m_word[1]);
+    return int64_cast(e.number());
+}
+
+inline std::uint64_t uint64_cast(element e) {
+    if (e.get_tag() == element::uint64_tag)
+        return e.m_word[1];
+    return uint64_cast(e.number());
+}
+
+inline string_view string_cast(element e) {
+    if (e.get_tag() != element::string_tag)
+        throw exception(error_code::bad_cast);
+    return { e.m_strings + e.payload(), std::size_t(e.m_word[1]) };
+}
+
+inline array_view array_cast(element e) {
+    if (e.get_tag() != element::array_tag)
+        throw exception(error_code::bad_cast);
+    return array_view(e);
+}
+
+inline object_view object_cast(element e) {
+    if (e.get_tag() != element::object_tag)
+        throw exception(error_code::bad_cast);
+    return object_view(e);
+}
+
+inline array_view::iterator::iterator(const std::uint64_t *word,
+                                      const char *strings) noexcept
+    : m_word(word), m_strings(strings) {}
+
+inline element array_view::iterator::operator*() const noexcept {
+    return element(m_word, m_strings);
+}
+
+inline array_view::iterator &array_view::iterator::operator++() noexcept {
+    m_word = element::skip(m_word);
+    return *this;
+}
+
+inline array_view::iterator array_view::iterator::operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+}
+
+inline bool array_view::iterator::operator==(const iterator &rhs) const
+    noexcept {
+    return m_word == rhs.m_word;
+}
+
+inline bool array_view::iterator::operator!=(const iterator &rhs) const
+    noexcept {
+    return m_word != rhs.m_word;
+}
+
+inline array_view::array_view(element e) noexcept : m_element(e) {}
+
+inline array_view::iterator array_view::begin() const noexcept {
+    return iterator(m_element.m_word + 2, m_element.m_strings);
+}
+
+inline array_view::iterator array_view::end() const noexcept {
+    return iterator(element::skip(m_element.m_word), m_element.m_strings);
+}
+
+inline std::size_t array_view::size() const noexcept {
+    return std::size_t(m_element.m_word[1]);
+}
+
+inline bool array_view::empty() const noexcept { return size() == 0; }
+
+inline element array_view::operator[](std::size_t i) const noexcept {
+    assert(i < size());
+    auto it = begin();
+    while (i--)
+        ++it;
+    return *it;
+}
+
+inline object_view::iterator::iterator(const std::uint64_t *word,
+                                       const char *strings) noexcept
+    : m_word(word), m_strings(strings) {}
+
+inline std::pair<string_view, element> object_view::iterator::
+operator*() const noexcept {
+    return { string_cast(element(m_word, m_strings)),
+             element(m_word + 2, m_strings) };
+}
+
+inline object_view::iterator &object_view::iterator::operator++() noexcept {
+    m_word = element::skip(m_word + 2);
+    return *this;
+}
+
+inline object_view::iterator object_view::iterator::operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+}
+
+inline bool object_view::iterator::operator==(const iterator &rhs) const
+    noexcept {
+    return m_word == rhs.m_word;
+}
+
+inline bool object_view::iterator::operator!=(const iterator &rhs) const
+    noexcept {
+    return m_word != rhs.m_word;
+}
+
+inline object_view::object_view(element e) noexcept : m_element(e) {}
+
+inline object_view::iterator object_view::begin() const noexcept {
+    return iterator(m_element.m_word + 2, m_element.m_strings);
+}
+
+inline object_view::iterator object_view::end() const noexcept {
+    return iterator(element::skip(m_element.m_word), m_element.m_strings);
+}
+
+inline std::size_t object_view::size() const noexcept {
+    return std::size_t(m_element.m_word[1]);
+}
+
+inline bool object_view::empty() const noexcept { return size() == 0; }
+
+inline object_view::iterator find(object_view obj, char const *name) {
+    const auto len = std::strlen(name);
+    auto it = obj.begin();
+    for (auto end = obj.end(); it != end; ++it) {
+        auto member_name = (*it).first;
+        if (member_name.length() == len &&
+            (member_name.data() == name ||
+             std::memcmp(member_name.data(), name, len) == 0))
+            break;
+    }
+    return it;
+}
+
+// --------------------------------------------------------------------------
+
 inline value::impl_t::~impl_t() {}
 
 // null
@@ -1018,6 +2307,68 @@ inline bool value::number_impl_t::equals(const impl_t *base) const noexcept {
     return ptr->number == number;
 }
 
+inline value::int64_impl_t::int64_impl_t(std::int64_t n) noexcept
+    : number(n) {}
+
+inline value_type value::int64_impl_t::type() const noexcept {
+    return value_type::number;
+}
+
+inline void value::int64_impl_t::clone(char *storage) const noexcept {
+    new (storage) int64_impl_t{ number };
+}
+
+inline bool value::int64_impl_t::equals(const impl_t *base) const noexcept {
+    const int64_impl_t *ptr = static_cast<const int64_impl_t *>(base);
+    return ptr->number == number;
+}
+
+inline value::uint64_impl_t::uint64_impl_t(std::uint64_t n) noexcept
+    : number(n) {}
+
+inline value_type value::uint64_impl_t::type() const noexcept {
+    return value_type::number;
+}
+
+inline void value::uint64_impl_t::clone(char *storage) const noexcept {
+    new (storage) uint64_impl_t{ number };
+}
+
+inline bool value::uint64_impl_t::equals(const impl_t *base) const noexcept {
+    const uint64_impl_t *ptr = static_cast<const uint64_impl_t *>(base);
+    return ptr->number == number;
+}
+
+// numbers are equal if their values are, compared exactly
+inline bool value::number_equals(const value &lhs_value,
+                                 const value &rhs_value) {
+    if (lhs_value.is_raw_number())
+        return convert_raw_number(lhs_value) == rhs_value;
+    if (rhs_value.is_raw_number())
+        return lhs_value == convert_raw_number(rhs_value);
+
+    auto lhs = lhs_value.impl();
+    auto rhs = rhs_value.impl();
+
+    // order the pair as (double or int64, int64 or uint64)
+    if (dynamic_cast<const number_impl_t *>(rhs) ||
+        dynamic_cast<const uint64_impl_t *>(lhs))
+        std::swap(lhs, rhs);
+
+    auto u = dynamic_cast<const uint64_impl_t *>(rhs);
+    if (auto i = dynamic_cast<const int64_impl_t *>(lhs))
+        return i->number >= 0 && std::uint64_t(i->number) == u->number;
+
+    // the casts back and forth reject fractions and rounded integers
+    auto d = static_cast<const number_impl_t *>(lhs)->number;
+    if (u)
+        return d >= 0 && d < 18446744073709551616.0 &&
+               std::uint64_t(d) == u->number && double(u->number) == d;
+    auto i = static_cast<const int64_impl_t *>(rhs)->number;
+    return d >= -9223372036854775808.0 && d < 9223372036854775808.0 &&
+           std::int64_t(d) == i && double(i) == d;
+}
+
 #ifdef UJSON_SHORT_STRING_OPTIMIZATION
 
 // short string
@@ -1072,6 +2423,64 @@ inline bool value::long_string_impl_t::equals(const impl_t *base) const
     return *derived->ptr == *ptr;
 }
 
+// raw numbers
+
+inline value::short_raw_number_impl_t::short_raw_number_impl_t(
+    const char *ptr, std::size_t len) {
+    assert(len <= sso_max_length);
+    std::memcpy(buffer, ptr, len);
+    buffer[len] = 0;
+    length = static_cast<std::uint8_t>(len);
+}
+
+inline value_type value::short_raw_number_impl_t::type() const noexcept {
+    return value_type::number;
+}
+
+inline void value::short_raw_number_impl_t::clone(char *storage) const
+    noexcept {
+    new (storage) short_raw_number_impl_t{ buffer, length };
+}
+
+inline bool value::short_raw_number_impl_t::equals(const impl_t *base) const
+    noexcept {
+    auto ptr = static_cast<const short_raw_number_impl_t *>(base);
+    return length == ptr->length &&
+           std::memcmp(ptr->buffer, buffer, length) == 0;
+}
+
+inline value::long_raw_number_impl_t::long_raw_number_impl_t(
+    std::shared_ptr<string> const &p)
+    : ptr(p) {}
+
+inline value_type value::long_raw_number_impl_t::type() const noexcept {
+    return value_type::number;
+}
+
+inline void value::long_raw_number_impl_t::clone(char *storage) const
+    noexcept {
+    new (storage) long_raw_number_impl_t{ ptr };
+}
+
+inline bool value::long_raw_number_impl_t::equals(const impl_t *base) const
+    noexcept {
+    auto derived = static_cast<const long_raw_number_impl_t *>(base);
+    return *derived->ptr == *ptr;
+}
+
+inline value value::make_raw_number(const char *ptr, std::size_t len) {
+    value result;
+    if (len <= sso_max_length) {
+        result.destroy();
+        new (result.m_storage) short_raw_number_impl_t{ ptr, len };
+    } else {
+        auto text = std::make_shared<string>(ptr, ptr + len); // may throw
+        result.destroy();
+        new (result.m_storage) long_raw_number_impl_t{ text };
+    }
+    return result;
+}
+
 #elif defined UJSON_REF_COUNTED_STRING
 
 inline value::string_impl_t::string_impl_t(string s) : str(std::move(s)) {}
@@ -1089,8 +2498,78 @@ inline bool value::string_impl_t::equals(const impl_t *base) const noexcept {
     return derived->str == str;
 }
 
+// raw numbers
+
+inline value::raw_number_impl_t::raw_number_impl_t(string s)
+    : str(std::move(s)) {}
+
+inline value_type value::raw_number_impl_t::type() const noexcept {
+    return value_type::number;
+}
+
+inline void value::raw_number_impl_t::clone(char *storage) const noexcept {
+    new (storage) raw_number_impl_t{ str };
+}
+
+inline bool value::raw_number_impl_t::equals(const impl_t *base) const
+    noexcept {
+    auto derived = static_cast<const raw_number_impl_t *>(base);
+    return derived->str == str;
+}
+
+inline value value::make_raw_number(const char *ptr, std::size_t len) {
+    string text(ptr, ptr + len); // may throw
+    value result;
+    result.destroy();
+    new (result.m_storage) raw_number_impl_t{ std::move(text) };
+    return result;
+}
+
 #endif
 
+// borrowed string
+
+inline value::borrowed_string_impl_t::borrowed_string_impl_t(
+    const char *p, std::size_t len) noexcept : ptr(p), length(len) {}
+
+inline value_type value::borrowed_string_impl_t::type() const noexcept {
+    return value_type::string;
+}
+
+inline void value::borrowed_string_impl_t::clone(char *storage) const
+    noexcept {
+    new (storage) borrowed_string_impl_t{ ptr, length };
+}
+
+inline bool value::borrowed_string_impl_t::equals(const impl_t *base) const
+    noexcept {
+    auto derived = static_cast<const borrowed_string_impl_t *>(base);
+    return length == derived->length &&
+           std::memcmp(ptr, derived->ptr, length) == 0;
+}
+
+inline value value::make_borrowed_string(const char *ptr,
+                                         std::size_t len) noexcept {
+    value result;
+    result.destroy();
+    new (result.m_storage) borrowed_string_impl_t{ ptr, len };
+    return result;
+}
+
+inline value value::make_array(const std::shared_ptr<array> &ptr) noexcept {
+    value result;
+    result.destroy();
+    new (result.m_storage) array_impl_t{ ptr };
+    return result;
+}
+
+inline value value::make_object(const std::shared_ptr<object> &ptr) noexcept {
+    value result;
+    result.destroy();
+    new (result.m_storage) object_impl_t{ ptr };
+    return result;
+}
+
 // array
 
 inline value::array_impl_t::array_impl_t(array a) {
@@ -1123,8 +2602,10 @@ inline value::object_impl_t::object_impl_t(object o, validate_utf8 validate) {
                 throw exception(error_code::bad_string);
         }
     }
-    
-    std::stable_sort(o.begin(), o.end());
+
+    // parsers sort members as they go
+    if (!std::is_sorted(o.begin(), o.end()))
+        std::stable_sort(o.begin(), o.end());
     ptr = std::make_shared<object>(std::move(o));
 }
 